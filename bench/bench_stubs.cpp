@@ -0,0 +1,36 @@
+/*
+ *  Symbols the core objects reference but that the tree does not define.
+ *  The benchmark loops never reach them; calling one aborts the run.
+ */
+
+#include "dosbox.h"
+#include "cpu.h"
+#include "setup.h"
+#include "control.h"
+#include "vfs/vfs_implementation.h"
+
+#define BENCH_MISSING(name) E_Exit("corebench: %s is not available",name)
+
+bool CPU_READ_DRX(Bitu /*dr*/,Bit32u & /*retvalue*/) { BENCH_MISSING("CPU_READ_DRX"); return false; }
+bool CPU_READ_TRX(Bitu /*dr*/,Bit32u & /*retvalue*/) { BENCH_MISSING("CPU_READ_TRX"); return false; }
+bool CPU_WRITE_CRX(Bitu /*cr*/,Bitu /*value*/) { BENCH_MISSING("CPU_WRITE_CRX"); return false; }
+bool CPU_WRITE_DRX(Bitu /*dr*/,Bitu /*value*/) { BENCH_MISSING("CPU_WRITE_DRX"); return false; }
+bool CPU_WRITE_TRX(Bitu /*dr*/,Bitu /*value*/) { BENCH_MISSING("CPU_WRITE_TRX"); return false; }
+void CPU_CMPXCHG8B(Bit32u /*addr*/) { BENCH_MISSING("CPU_CMPXCHG8B"); }
+void CPU_LAR(Bitu /*selector*/,Bitu & /*ar*/) { BENCH_MISSING("CPU_LAR"); }
+void CPU_LSL(Bitu /*selector*/,Bitu & /*limit*/) { BENCH_MISSING("CPU_LSL"); }
+void CPU_ARPL(Bitu & /*dest_sel*/,Bitu /*src_sel*/) { BENCH_MISSING("CPU_ARPL"); }
+bool CPU_LMSW(Bitu /*word*/) { BENCH_MISSING("CPU_LMSW"); return false; }
+Bitu CPU_SMSW(void) { BENCH_MISSING("CPU_SMSW"); return 0; }
+void CPU_VERR(Bitu /*selector*/) { BENCH_MISSING("CPU_VERR"); }
+void CPU_VERW(Bitu /*selector*/) { BENCH_MISSING("CPU_VERW"); }
+bool CPU_CPUID(void) { BENCH_MISSING("CPU_CPUID"); return false; }
+void CPU_ENTER(bool /*use32*/,Bitu /*bytes*/,Bitu /*level*/) { BENCH_MISSING("CPU_ENTER"); }
+Section * Config::GetSection(int /*index*/) { BENCH_MISSING("Config::GetSection"); return 0; }
+
+/* The frontend normally provides the VFS, the benchmark has no directories */
+libretro_vfs_implementation_dir * retro_vfs_opendir_impl(const char * /*dir*/,bool /*include_hidden*/) { return 0; }
+bool retro_vfs_readdir_impl(libretro_vfs_implementation_dir * /*dirstream*/) { return false; }
+const char * retro_vfs_dirent_get_name_impl(libretro_vfs_implementation_dir * /*dirstream*/) { return 0; }
+bool retro_vfs_dirent_is_dir_impl(libretro_vfs_implementation_dir * /*dirstream*/) { return false; }
+int retro_vfs_closedir_impl(libretro_vfs_implementation_dir * /*dirstream*/) { return 0; }
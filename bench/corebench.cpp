@@ -0,0 +1,128 @@
+/*
+ *  Interpreter core throughput.
+ *
+ *  Runs each CPU core directly, without booting DOS, on a real-mode loop
+ *  that loads, adds, xors and stores words across a 16KB buffer. Prints
+ *  the instructions per second and a checksum of the buffer, which must be
+ *  the same for every interpreter core and build. The dynrec core only
+ *  stops at the end of a translated block, so it runs a few more
+ *  instructions than asked for and its checksum differs from the interpreters' but must
+ *  be the same between its builds. "make bench" links it twice, as
+ *  corebench-inline and corebench-noinline, with the interpreter cores
+ *  built with and without C_CORE_INLINE.
+ *
+ *  Usage: corebench [cycles per core, default 2e8] [core name]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#include "dosbox.h"
+#include "mem.h"
+#include "paging.h"
+#include "cpu.h"
+#include "regs.h"
+#include "setup.h"
+#include "control.h"
+
+void MEM_Init(Section * sec);
+void PAGING_Init(Section * sec);
+void IO_Init(Section * sec);
+void CPU_Core_Normal_Init(void);
+void CPU_Core_Simple_Init(void);
+void CPU_Core_Full_Init(void);
+void CPU_Core_Prefetch_Init(void);
+#if (C_DYNREC)
+void CPU_Core_Dynrec_Init(void);
+void CPU_Core_Dynrec_Cache_Init(bool enable_cache);
+#endif
+
+/* Loaded at 1000:0100, works on the buffer at 3000:0000
+ *		xor bx,bx
+ *	again:	xor si,si
+ *		mov cx,8192
+ *	inner:	mov ax,[si]
+ *		add ax,bx
+ *		xor ax,5a5ah
+ *		mov [si],ax
+ *		mov dl,[si+1]
+ *		add bl,dl
+ *		add si,2
+ *		and si,3fffh
+ *		loop inner
+ *		jmp again
+ */
+static const Bit8u bench_loop[] = {
+	0x31,0xdb,0x31,0xf6,0xb9,0x00,0x20,0x8b,0x04,0x01,0xd8,0x35,
+	0x5a,0x5a,0x89,0x04,0x8a,0x54,0x01,0x00,0xd3,0x83,0xc6,0x02,
+	0x81,0xe6,0xff,0x3f,0xe2,0xe9,0xeb,0xe2
+};
+
+static struct {
+	const char * name;
+	CPU_Decoder * decoder;
+} bench_cores[] = {
+	{ "normal",		CPU_Core_Normal_Run },
+	{ "simple",		CPU_Core_Simple_Run },
+	{ "prefetch",	CPU_Core_Prefetch_Run },
+	{ "full",		CPU_Core_Full_Run },
+#if (C_DYNREC)
+	{ "dynrec",		CPU_Core_Dynrec_Run },
+#endif
+};
+
+int main(int argc,char * argv[]) {
+	const char * args[] = { "corebench" };
+	CommandLine cmdline(1,args);
+	control = new Config(&cmdline);
+	DOSBOX_Init();
+	Section * sec = control->GetSection("dosbox");
+	IO_Init(sec);
+	PAGING_Init(sec);
+	MEM_Init(sec);
+	CPU_Core_Normal_Init();
+	CPU_Core_Simple_Init();
+	CPU_Core_Full_Init();
+	CPU_Core_Prefetch_Init();
+	CPU_PrefetchQueueSize = 16;	/* as for cputype 386_prefetch */
+#if (C_DYNREC)
+	CPU_Core_Dynrec_Init();
+	CPU_Core_Dynrec_Cache_Init(true);
+#endif
+
+	long total = argc>1 ? atol(argv[1]) : 200000000;
+	for (size_t i=0;i<sizeof(bench_cores)/sizeof(bench_cores[0]);i++) {
+		if (argc>2 && strcmp(argv[2],bench_cores[i].name)) continue;
+		MEM_BlockWrite(0x10100,bench_loop,sizeof(bench_loop));
+		for (PhysPt addr=0x30000;addr<0x34000;addr++) mem_writeb(addr,0);
+		cpu.pmode = false;
+		cpu.code.big = false;
+		cpu.cpl = 0;
+		SegSet16(cs,0x1000);
+		SegSet16(ds,0x3000);
+		SegSet16(es,0x3000);
+		SegSet16(ss,0x2000);
+		reg_esp = 0xfffe;
+		reg_eip = 0x100;
+		reg_flags = 0x2;
+		reg_eax = reg_ebx = reg_ecx = reg_edx = reg_esi = reg_edi = 0;
+
+		long done = 0;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		while (done<total) {
+			CPU_Cycles = 100000;
+			CPU_CycleLeft = 0;
+			bench_cores[i].decoder();
+			done += 100000-CPU_Cycles;
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+		Bit32u sum = 0;
+		for (PhysPt addr=0x30000;addr<0x34000;addr++) sum = sum*31+mem_readb(addr);
+		printf("%-8s %8.1f Minsn/s  %.3fs  checksum %08x\n",
+			bench_cores[i].name,done/seconds/1e6,seconds,sum);
+	}
+	return 0;
+}
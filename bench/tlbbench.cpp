@@ -0,0 +1,134 @@
+/*
+ *  Flat versus sparse TLB, see include/paging.h.
+ *
+ *  Standalone model of the USE_FULL_TLB layouts: the flat one with five
+ *  arrays over all 1M linear pages, and the USE_SPARSE_TLB one with a
+ *  directory of 4MB chunks that point to a shared cleared chunk until a page
+ *  in them is linked. Both are filled like a DOS extender would (low 16MB,
+ *  a 4MB linear framebuffer and the BIOS page), then the resident size of
+ *  the TLB and the cost of random read lookups are measured.
+ *
+ *  Build with -DSPARSE_TLB=0 or -DSPARSE_TLB=1, or use "make bench".
+ *  Usage: tlbbench [working set in MB, default 16] [lookups, default 2e8]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <chrono>
+
+typedef uint8_t * HostPt;
+class PageHandler { };
+static PageHandler init_page_handler;
+
+#define TLB_SIZE		(1024*1024)
+#define TLB_CHUNK_SHIFT	10
+#define TLB_CHUNK_SIZE	(1 << TLB_CHUNK_SHIFT)
+#define TLB_CHUNK_MASK	(TLB_CHUNK_SIZE-1)
+#define TLB_CHUNKS		(TLB_SIZE >> TLB_CHUNK_SHIFT)
+
+#if SPARSE_TLB
+typedef struct {
+	HostPt read[TLB_CHUNK_SIZE];
+	HostPt write[TLB_CHUNK_SIZE];
+	PageHandler * readhandler[TLB_CHUNK_SIZE];
+	PageHandler * writehandler[TLB_CHUNK_SIZE];
+	uint32_t phys_page[TLB_CHUNK_SIZE];
+} tlb_chunk;
+
+static tlb_chunk tlb_clear;
+static tlb_chunk * tlbdir[TLB_CHUNKS];
+
+static void tlb_init(void) {
+	for (int i=0;i<TLB_CHUNK_SIZE;i++) {
+		tlb_clear.readhandler[i]=&init_page_handler;
+		tlb_clear.writehandler[i]=&init_page_handler;
+	}
+	for (int i=0;i<TLB_CHUNKS;i++) tlbdir[i]=&tlb_clear;
+}
+
+static void tlb_link(uint32_t lin_page,HostPt host) {
+	tlb_chunk * & chunk=tlbdir[lin_page >> TLB_CHUNK_SHIFT];
+	if (chunk==&tlb_clear) {
+		chunk=(tlb_chunk *)malloc(sizeof(tlb_chunk));
+		memcpy(chunk,&tlb_clear,sizeof(tlb_chunk));
+	}
+	chunk->read[lin_page & TLB_CHUNK_MASK]=host-(lin_page << 12);
+	chunk->write[lin_page & TLB_CHUNK_MASK]=host-(lin_page << 12);
+	chunk->phys_page[lin_page & TLB_CHUNK_MASK]=lin_page;
+}
+
+static inline HostPt tlb_read(uint32_t lin_page) {
+	return tlbdir[lin_page >> TLB_CHUNK_SHIFT]->read[lin_page & TLB_CHUNK_MASK];
+}
+#else
+static struct {
+	HostPt read[TLB_SIZE];
+	HostPt write[TLB_SIZE];
+	PageHandler * readhandler[TLB_SIZE];
+	PageHandler * writehandler[TLB_SIZE];
+	uint32_t phys_page[TLB_SIZE];
+} tlb;
+
+static void tlb_init(void) {
+	for (int i=0;i<TLB_SIZE;i++) {
+		tlb.read[i]=0;
+		tlb.write[i]=0;
+		tlb.readhandler[i]=&init_page_handler;
+		tlb.writehandler[i]=&init_page_handler;
+	}
+}
+
+static void tlb_link(uint32_t lin_page,HostPt host) {
+	tlb.read[lin_page]=host-(lin_page << 12);
+	tlb.write[lin_page]=host-(lin_page << 12);
+	tlb.phys_page[lin_page]=lin_page;
+}
+
+static inline HostPt tlb_read(uint32_t lin_page) {
+	return tlb.read[lin_page];
+}
+#endif
+
+/* Resident set in KB */
+static long resident(void) {
+	long size=0,pages=0;
+	FILE * f=fopen("/proc/self/statm","r");
+	if (!f) return 0;
+	if (fscanf(f,"%ld %ld",&size,&pages)!=2) pages=0;
+	fclose(f);
+	return pages*4;
+}
+
+int main(int argc,char * argv[]) {
+	uint32_t set_mb=argc>1 ? (uint32_t)atoi(argv[1]) : 16;
+	long lookups=argc>2 ? atol(argv[2]) : 200000000;
+	if (set_mb<1 || set_mb>16) set_mb=16;
+
+	static uint8_t memory[16 << 20];
+	long before=resident();
+	tlb_init();
+	for (uint32_t page=0;page<4096;page++) tlb_link(page,memory+(page << 12));
+	for (uint32_t page=0xe0000;page<0xe0400;page++) tlb_link(page,memory+((page & 0x3ff) << 12));
+	tlb_link(0xfffff,memory);
+	long after=resident();
+	for (uint32_t i=0;i<sizeof(memory);i++) memory[i]=(uint8_t)i;
+
+	/* Random addresses inside the working set, so both layouts see the same
+	 * cache behaviour for the host memory behind the pages */
+	uint32_t mask=(set_mb << 20)-1;
+	uint32_t seed=1;
+	uint64_t sum=0;
+	std::chrono::steady_clock::time_point start=std::chrono::steady_clock::now();
+	for (long i=0;i<lookups;i++) {
+		seed=seed*1664525u+1013904223u;
+		uint32_t address=(seed >> 8) & mask;
+		HostPt host=tlb_read(address >> 12);
+		if (host) sum+=host[address];
+	}
+	double ns=std::chrono::duration<double,std::nano>(std::chrono::steady_clock::now()-start).count()/lookups;
+	printf("%s: %ld KB TLB resident, %.3f ns/lookup over %uMB (sum %llu)\n",
+		SPARSE_TLB ? "sparse" : "flat",after-before,ns,set_mb,(unsigned long long)sum);
+	return 0;
+}
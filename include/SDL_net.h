@@ -1 +1,110 @@
-// INTENTIONALLY BLANK
+#ifndef SDL_NET_FAKE_
+#define SDL_NET_FAKE_
+
+// Replacement for the subset of SDL_net used by the IPX tunnel (ipx.cpp,
+// ipxserver.cpp) and the serial modem/nullmodem (misc_util.cpp), built on
+// native BSD sockets in libretro/SDL_net.cpp. Addresses and ports are kept
+// in network byte order like the real SDL_net.
+
+#include "SDL.h"
+
+typedef struct {
+    Uint32 host;
+    Uint16 port;
+} IPaddress;
+
+// Number of UDP channels per socket, each channel holds a single address.
+#define SDLNET_MAX_UDPCHANNELS 32
+// Datagrams fetched from the kernel per receive call, SDLNet_UDP_Recv hands
+// them out one at a time before going back to the socket.
+#define SDLNET_UDP_BATCH 16
+#define SDLNET_UDP_MAXPACKET 1500
+// Stream data the kernel did not take yet, SDLNet_TCP_Send queues it in the
+// socket and SDLNet_CheckSockets keeps handing it over.
+#define SDLNET_TCP_SENDBUF 16384
+
+typedef struct _TCPsocket *TCPsocket;
+typedef struct _UDPsocket *UDPsocket;
+typedef struct _SDLNet_SocketSet *SDLNet_SocketSet;
+
+// Common head of TCPsocket and UDPsocket, the layout is relied upon by
+// misc_util.cpp which builds TCPsocket structures for native sockets.
+typedef struct _SDLNet_GenericSocket {
+    int ready;
+    int channel;
+} *SDLNet_GenericSocket;
+
+typedef struct {
+    int channel;
+    Uint8 *data;
+    int len;
+    int maxlen;
+    int status;
+    IPaddress address;
+} UDPpacket;
+
+// Defined in dosbox.cpp
+extern bool SDLNetInited;
+
+int SDLNet_Init(void);
+void SDLNet_Quit(void);
+const char *SDLNet_GetError(void);
+
+int SDLNet_ResolveHost(IPaddress *address, const char *host, Uint16 port);
+
+// A host of INADDR_ANY or INADDR_NONE opens a listening socket.
+TCPsocket SDLNet_TCP_Open(IPaddress *ip);
+TCPsocket SDLNet_TCP_Accept(TCPsocket server);
+IPaddress *SDLNet_TCP_GetPeerAddress(TCPsocket sock);
+int SDLNet_TCP_Send(TCPsocket sock, const void *data, int len);
+int SDLNet_TCP_Recv(TCPsocket sock, void *data, int maxlen);
+void SDLNet_TCP_Close(TCPsocket sock);
+
+UDPsocket SDLNet_UDP_Open(Uint16 port);
+int SDLNet_UDP_Bind(UDPsocket sock, int channel, const IPaddress *address);
+int SDLNet_UDP_Send(UDPsocket sock, int channel, UDPpacket *packet);
+int SDLNet_UDP_Recv(UDPsocket sock, UDPpacket *packet);
+void SDLNet_UDP_Close(UDPsocket sock);
+
+SDLNet_SocketSet SDLNet_AllocSocketSet(int maxsockets);
+int SDLNet_AddSocket(SDLNet_SocketSet set, SDLNet_GenericSocket sock);
+int SDLNet_DelSocket(SDLNet_SocketSet set, SDLNet_GenericSocket sock);
+int SDLNet_CheckSockets(SDLNet_SocketSet set, Uint32 timeout);
+void SDLNet_FreeSocketSet(SDLNet_SocketSet set);
+
+// TCP sockets in a set also get their connect() finished and send buffer
+// flushed by SDLNet_CheckSockets.
+int SDLNet_TCP_AddSocket(SDLNet_SocketSet set, TCPsocket sock);
+#define SDLNet_TCP_DelSocket(set, sock) SDLNet_DelSocket(set, (SDLNet_GenericSocket)(sock))
+#define SDLNet_SocketReady(sock) ((sock) != NULL && ((SDLNet_GenericSocket)(sock))->ready)
+
+// Big endian accessors for packet headers
+inline void SDLNet_Write16(Uint16 value, void *area)
+{
+    Uint8 *p = (Uint8 *)area;
+    p[0] = (Uint8)(value >> 8);
+    p[1] = (Uint8)value;
+}
+
+inline void SDLNet_Write32(Uint32 value, void *area)
+{
+    Uint8 *p = (Uint8 *)area;
+    p[0] = (Uint8)(value >> 24);
+    p[1] = (Uint8)(value >> 16);
+    p[2] = (Uint8)(value >> 8);
+    p[3] = (Uint8)value;
+}
+
+inline Uint16 SDLNet_Read16(const void *area)
+{
+    const Uint8 *p = (const Uint8 *)area;
+    return (Uint16)((p[0] << 8) | p[1]);
+}
+
+inline Uint32 SDLNet_Read32(const void *area)
+{
+    const Uint8 *p = (const Uint8 *)area;
+    return ((Uint32)p[0] << 24) | ((Uint32)p[1] << 16) | ((Uint32)p[2] << 8) | p[3];
+}
+
+#endif
@@ -43,6 +43,8 @@ struct diskGeo {
 };
 extern diskGeo DiskGeometryList[];
 
+class CompressedImage;
+
 class imageDisk  {
 public:
 	Bit8u Read_Sector(Bit32u head,Bit32u cylinder,Bit32u sector,void * data);
@@ -55,7 +57,7 @@ public:
 	Bit8u GetBiosType(void);
 	Bit32u getSectSize(void);
 	imageDisk(FILE *imgFile, Bit8u *imgName, Bit32u imgSizeK, bool isHardDisk);
-	~imageDisk() { if(diskimg != NULL) { fclose(diskimg); }	};
+	~imageDisk();
 
 	bool hardDrive;
 	bool active;
@@ -68,6 +70,7 @@ public:
 private:
 	Bit32u current_fpos;
 	enum { NONE,READ,WRITE } last_action;
+	CompressedImage *compressed;	// read-only, NULL for plain images
 };
 
 void updateDPT(void);
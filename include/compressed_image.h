@@ -0,0 +1,99 @@
+/*
+ *  Copyright (C) 2002-2015  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef DOSBOX_COMPRESSED_IMAGE_H
+#define DOSBOX_COMPRESSED_IMAGE_H
+
+#include <stdio.h>
+#include <list>
+#include <map>
+#include <set>
+#include <deque>
+#include <vector>
+#if defined(C_ZLIB)
+#include <mutex>
+#include <condition_variable>
+#if defined(C_IMAGE_PREFETCH)
+#include <thread>
+#endif
+#endif
+
+#ifndef DOSBOX_DOSBOX_H
+#include "dosbox.h"
+#endif
+
+/* Read-only access to a block compressed image (CISO container: a header,
+ * a table with the file offset of every hunk and independently deflated
+ * hunks). Used for CD data tracks and for floppy and hard disk images.
+ * Decompressed hunks are kept in a LRU cache, sequential readers get the
+ * following hunks inflated ahead of time on worker threads. */
+class CompressedImage {
+public:
+	/* The file stays owned by the caller and must outlive the image */
+	CompressedImage(FILE *file);
+	~CompressedImage();
+	bool IsValid(void) const { return valid; }
+	Bit64u GetSize(void) const { return size; }
+	bool Read(Bit8u *buffer, Bit64u offset, Bitu count);
+
+	static bool Detect(FILE *file);
+	/* Size of the image data in file, looking through the container */
+	static Bit64u GetImageSize(FILE *file);
+
+private:
+	bool valid;
+	Bit64u size;
+#if defined(C_ZLIB)
+	struct Hunk {
+		std::list<Bit32u>::iterator pos;
+		std::vector<Bit8u> data;
+	};
+	bool Decode(Bit32u hunk, std::vector<Bit8u> &out, std::vector<Bit8u> &in, void *stream);
+	bool CopyCached(Bit32u hunk, Bit8u *buffer, Bitu offset, Bitu count);
+	void Insert(Bit32u hunk, std::vector<Bit8u> &data);
+	void Prefetch(Bit32u first, Bit32u last);
+	void Worker(void);
+
+	FILE *file;
+	Bitu hunkSize;
+	Bitu hunkCount;
+	Bitu align;
+	std::vector<Bit32u> index;
+
+	std::mutex fileLock;			// file position and reads
+	std::mutex lock;			// everything below
+	std::condition_variable wake;
+	std::condition_variable done;
+	std::map<Bit32u,Hunk> hunks;
+	std::list<Bit32u> order;		// most recently used first
+	Bitu cacheHunks;
+	std::deque<Bit32u> queue;
+	std::set<Bit32u> queued;
+	std::set<Bit32u> inflight;
+	Bit64u nextOffset;
+	std::vector<Bit8u> scratchIn;
+	std::vector<Bit8u> scratchOut;
+	void *stream;
+	bool quit;
+#if defined(C_IMAGE_PREFETCH)
+	std::vector<std::thread> workers;
+#endif
+#endif
+};
+
+#endif
@@ -46,10 +46,11 @@
 
 // ----- DOSBOX CORE FEATURES: Many of these probably won't work even if you enable them
 #define C_FPU 1 /* Define to 1 to enable floating point emulation */
-/* #undef C_CORE_INLINE */ /* Define to 1 to use inlined memory functions in cpu core */
+/* #undef C_CORE_INLINE */ /* Define to 1 to use inlined memory functions in cpu core, set by WITH_CORE_INLINE in Makefile.common */
 /* #undef C_DIRECTSERIAL */ /* Define to 1 if you want serial passthrough support (Win32, Posix and OS/2). */
-/* #undef C_IPX */ /* Define to 1 to enable IPX over Internet networking, requires SDL_net */
-/* #undef C_MODEM */ /* Define to 1 to enable internal modem support, requires SDL_net */
+/* #undef C_IPX */ /* Define to 1 to enable IPX over Internet networking, set by WITH_NETWORK in Makefile.common */
+/* #undef C_MODEM */ /* Define to 1 to enable internal modem support, set by WITH_NETWORK in Makefile.common */
+/* #undef C_OPL_THREAD */ /* Define to 1 to run the fast OPL emulation on a worker thread, set by WITH_OPL_THREAD in Makefile.common */
 /* #undef C_SDL_SOUND */ /* Define to 1 to enable SDL_sound support */
 
 // ----- HEADERS: Define if headers exist in build environment
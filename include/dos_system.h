@@ -23,6 +23,8 @@
 #define DOSBOX_DOS_SYSTEM_H
 
 #include <vector>
+#include <string>
+#include <unordered_map>
 #ifndef DOSBOX_DOSBOX_H
 #include "dosbox.h"
 #endif
@@ -124,6 +126,8 @@ private:
  * The negative side effect: The stored searches will be turned over faster.
  * Should not have impact on systems with few directory entries. */
 #define MAX_OPENDIRS 2048
+// Resolved directory paths remembered per drive cache
+#define MAX_CACHEDPATHS 1024
 //Can be high as it's only storage (16 bit variable)
 
 class DOS_Drive_Cache {
@@ -202,9 +206,15 @@ private:
 	char		basePath			[CROSS_LEN];
 	bool		dirFirstTime;
 	TDirSort	sortDirType;
-	CFileInfo*	save_dir;
-	char		save_path			[CROSS_LEN];
-	char		save_expanded		[CROSS_LEN];
+	// Resolved paths, an entry is only valid while its generation matches.
+	// Anything that adds or drops entries bumps pathGeneration.
+	struct CachedPath {
+		CFileInfo*	dir;
+		std::string	expanded;
+		Bitu		generation;
+	};
+	std::unordered_map<std::string,CachedPath> pathCache;
+	Bitu		pathGeneration;
 
 	Bit16u		srchNr;
 	CFileInfo*	dirSearch			[MAX_OPENDIRS];
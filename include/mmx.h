@@ -86,4 +86,18 @@ Bit16u SaturateDwordSToWordU(Bit32s value);
 
 void   setFPU(Bit16u tag);
 
+// On SSE2 hosts the packed operations are done in the low half of a vector
+// register, which matches the MMX semantics including out of range shifts.
+#if defined(__SSE2__) && !defined(WORDS_BIGENDIAN)
+#include <emmintrin.h>
+#define MMX_SSE2 1
+
+static INLINE __m128i MMX_Load(const MMX_reg * reg) {
+	return _mm_loadl_epi64((const __m128i *)reg);
+}
+static INLINE void MMX_Store(MMX_reg * reg,__m128i val) {
+	_mm_storel_epi64((__m128i *)reg,val);
+}
+#endif
+
 #endif
\ No newline at end of file
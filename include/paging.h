@@ -28,6 +28,11 @@
 
 #ifndef GEKKO
 #define USE_FULL_TLB
+#if !(C_DYNAMIC_X86)
+// The full TLB is split into 4MB chunks that get allocated when a page in
+// them is first linked, the x86 dynamic core indexes the flat arrays directly
+#define USE_SPARSE_TLB
+#endif
 #endif
 
 class PageDirectory;
@@ -37,6 +42,12 @@ class PageDirectory;
 
 #if defined(USE_FULL_TLB)
 #define TLB_SIZE		(1024*1024)
+#if defined(USE_SPARSE_TLB)
+#define TLB_CHUNK_SHIFT	10
+#define TLB_CHUNK_SIZE	(1 << TLB_CHUNK_SHIFT)
+#define TLB_CHUNK_MASK	(TLB_CHUNK_SIZE-1)
+#define TLB_CHUNKS		(TLB_SIZE >> TLB_CHUNK_SHIFT)
+#endif
 #else
 #define TLB_SIZE		65536
 #define BANK_SHIFT		28
@@ -85,6 +96,10 @@ void PAGING_ClearTLB(void);
 void PAGING_LinkPage(Bitu lin_page,Bitu phys_page);
 void PAGING_LinkPage_ReadOnly(Bitu lin_page,Bitu phys_page);
 void PAGING_UnlinkPages(Bitu lin_page,Bitu pages);
+/* Change the direct write pointer of a page that is linked to handler in
+ * place, without taking a new link. NULL makes writes go to the handler. */
+bool PAGING_SetPageWrite(Bitu lin_page,PageHandler * handler,HostPt host);
+void PAGING_InvalidatePages(Bitu lin_page,Bitu pages);
 void PAGING_MapPage(Bitu lin_page,Bitu phys_page);
 bool PAGING_MakePhysPage(Bitu & page);
 bool PAGING_ForcePageInit(Bitu lin_addr);
@@ -132,7 +147,15 @@ union X86PageEntry {
     X86_PageEntryBlock block;
 };
 
-#if !defined(USE_FULL_TLB)
+#if defined(USE_SPARSE_TLB)
+typedef struct {
+    HostPt read[TLB_CHUNK_SIZE];
+    HostPt write[TLB_CHUNK_SIZE];
+    PageHandler * readhandler[TLB_CHUNK_SIZE];
+    PageHandler * writehandler[TLB_CHUNK_SIZE];
+    Bit32u	phys_page[TLB_CHUNK_SIZE];
+} tlb_chunk;
+#elif !defined(USE_FULL_TLB)
 typedef struct {
     HostPt read;
     HostPt write;
@@ -149,7 +172,11 @@ struct PagingBlock {
         Bitu page;
         PhysPt addr;
     } base;
-#if defined(USE_FULL_TLB)
+#if defined(USE_SPARSE_TLB)
+    // Chunks that were never filled point to a shared cleared chunk, so
+    // lookups need no presence check
+    tlb_chunk * tlbdir[TLB_CHUNKS];
+#elif defined(USE_FULL_TLB)
     struct {
         HostPt read[TLB_SIZE];
         HostPt write[TLB_SIZE];
@@ -183,7 +210,34 @@ bool mem_unalignedreadd_checked(PhysPt address,Bit32u * val);
 bool mem_unalignedwritew_checked(PhysPt address,Bit16u val);
 bool mem_unalignedwrited_checked(PhysPt address,Bit32u val);
 
-#if defined(USE_FULL_TLB)
+#if defined(USE_SPARSE_TLB)
+
+[[gnu::always_inline, gnu::hot]] static inline tlb_chunk *get_tlb_chunk(PhysPt address) {
+    return paging.tlbdir[address >> (12 + TLB_CHUNK_SHIFT)];
+}
+
+[[gnu::always_inline, gnu::hot]] static inline HostPt get_tlb_read(PhysPt address) {
+    return get_tlb_chunk(address)->read[(address >> 12) & TLB_CHUNK_MASK];
+}
+[[gnu::always_inline, gnu::hot]] static inline HostPt get_tlb_write(PhysPt address) {
+    return get_tlb_chunk(address)->write[(address >> 12) & TLB_CHUNK_MASK];
+}
+[[gnu::always_inline, gnu::hot]] static inline PageHandler* get_tlb_readhandler(PhysPt address) {
+    return get_tlb_chunk(address)->readhandler[(address >> 12) & TLB_CHUNK_MASK];
+}
+[[gnu::always_inline, gnu::hot]] static inline PageHandler* get_tlb_writehandler(PhysPt address) {
+    return get_tlb_chunk(address)->writehandler[(address >> 12) & TLB_CHUNK_MASK];
+}
+
+[[gnu::always_inline]] static inline PhysPt PAGING_GetPhysicalPage(PhysPt linePage) {
+    return get_tlb_chunk(linePage)->phys_page[(linePage >> 12) & TLB_CHUNK_MASK] << 12;
+}
+
+[[gnu::always_inline]] static inline PhysPt PAGING_GetPhysicalAddress(PhysPt linAddr) {
+    return (get_tlb_chunk(linAddr)->phys_page[(linAddr >> 12) & TLB_CHUNK_MASK] << 12) | (linAddr & 0xfff);
+}
+
+#elif defined(USE_FULL_TLB)
 
 [[gnu::always_inline, gnu::hot]] static inline HostPt get_tlb_read(PhysPt address) {
     return paging.tlb.read[address >> 12];
@@ -31,7 +31,7 @@
 
 #define RENDER_SKIP_CACHE	16
 //Enable this for scalers to support 0 input for empty lines
-//#define RENDER_NULL_INPUT
+#define RENDER_NULL_INPUT
 
 typedef struct {
 	struct { 
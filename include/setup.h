@@ -121,15 +121,20 @@ private:
 	bool set_double(std::string const& in);
 };
 
+class Section;
 class Property {
 public:
 	struct Changeable { enum Value {Always, WhenIdle,OnlyAtStart};};
+	/* Applies a changed value in place, without reinitialising the section */
+	typedef void (*ChangeFunction)(Section*);
 	const std::string propname;
 
-	Property(std::string const& _propname, Changeable::Value when):propname(_propname),change(when) { }
+	Property(std::string const& _propname, Changeable::Value when):propname(_propname),change(when),changefunction(0) { }
 	void Set_values(const char * const * in);
 	void Set_help(std::string const& str);
 	char const* Get_help();
+	void Set_change_function(ChangeFunction func) { changefunction = func; }
+	ChangeFunction Get_change_function() const { return changefunction; }
 	virtual	bool SetValue(std::string const& str)=0;
 	Value const& GetValue() const { return value;}
 	Value const& Get_Default_Value() const { return default_value; }
@@ -137,6 +142,8 @@ public:
 	//Type specific properties are encouraged to override this and check for type
 	//specific features.
 	virtual bool CheckValue(Value const& in, bool warn);
+	//CheckString returns true, if SetValue would accept str. Nothing is changed.
+	virtual bool CheckString(std::string const& str);
 public:
 	virtual ~Property(){ } 
 	virtual const std::vector<Value>& GetValues() const;
@@ -158,6 +165,7 @@ protected:
 	typedef std::vector<Value>::iterator iter;
 	Value default_value;
 	const Changeable::Value change;
+	ChangeFunction changefunction;
 };
 
 class Prop_int:public Property {
@@ -177,6 +185,7 @@ public:
 	int getMax() { return max;}
 	void SetMinMax(Value const& min,Value const& max) {this->min = min; this->max=max;}
 	bool SetValue(std::string const& in);
+	bool CheckString(std::string const& in);
 	~Prop_int(){ }
 	virtual bool CheckValue(Value const& in, bool warn);
 	// Override SetVal, so it takes min,max in account when there are no suggested values
@@ -214,6 +223,7 @@ public:
 	}
 	bool SetValue(std::string const& in);
 	virtual bool CheckValue(Value const& in, bool warn);
+	bool CheckString(std::string const& in);
 	~Prop_string(){ }
 };
 class Prop_path:public Prop_string{
@@ -225,6 +235,7 @@ public:
 		realpath = _value;
 	}
 	bool SetValue(std::string const& in);
+	bool CheckString(std::string const& in);
 	~Prop_path(){ }
 };
 
@@ -290,6 +301,7 @@ public:
 	Prop_multival_remain *Add_multiremain(std::string const& _propname, Property::Changeable::Value when,std::string const& sep);
 
 	Property* Get_prop(int index);
+	Property* Get_prop(std::string const& _propname);
 	int Get_int(std::string const& _propname) const;
 	const char* Get_string(std::string const& _propname) const;
 	bool Get_bool(std::string const& _propname) const;
@@ -299,6 +311,10 @@ public:
 	Prop_multival* Get_multival(std::string const& _propname) const;
 	Prop_multival_remain* Get_multivalremain(std::string const& _propname) const;
 	bool HandleInputline(std::string const& gegevens);
+	/* Sets several properties at once. Unchanged values are skipped, changes
+	 * are applied through the change functions if all changed properties have
+	 * one, otherwise the section is reinitialised once. */
+	bool ApplyValues(std::vector<std::pair<std::string,std::string> > const& values);
 	void PrintData(FILE* outfile) const;
 	virtual std::string GetPropValue(std::string const& _property) const;
 	//ExecuteDestroy should be here else the destroy functions use destroyed properties
@@ -310,6 +326,7 @@ protected:
 	Section_prop* section;
 	std::string separator;
 	void make_default_value();
+	bool ParseParts(std::string const& input, bool remain, bool apply);
 public:
 	Prop_multival(std::string const& _propname, Changeable::Value when,std::string const& sep):Property(_propname,when), section(new Section_prop("")),separator(sep) {
 		default_value = value = "";
@@ -317,6 +334,7 @@ public:
 	Section_prop *GetSection() { return section; }
 	const Section_prop *GetSection() const { return section; }
 	virtual bool SetValue(std::string const& input);
+	virtual bool CheckString(std::string const& input);
 	virtual const std::vector<Value>& GetValues() const;
 	~Prop_multival() { delete section; }
 }; //value bevat totale string. setvalue zet elk van de sub properties en checked die.
@@ -326,6 +344,7 @@ public:
 	Prop_multival_remain(std::string const& _propname, Changeable::Value when,std::string const& sep):Prop_multival(_propname,when,sep){ }
 
 	virtual bool SetValue(std::string const& input);
+	virtual bool CheckString(std::string const& input);
 };
 
    
@@ -30,6 +30,7 @@
 
 #include <string>
 #include <list>
+#include <vector>
 
 #define CMD_MAXLINE 4096
 #define CMD_MAXCMDS 20
@@ -55,6 +56,15 @@ public:
 	BatchFile * prev;
 	CommandLine * cmd;
 	std::string filename;
+private:
+	/* The file is read once and kept with its labels, it is only read
+	 * again when the size or the date changes */
+	bool LoadFile(void);
+	std::string contents;
+	std::vector<std::pair<std::string,Bit32u> > labels;
+	bool loaded;
+	Bit32u loaded_size;
+	Bit16u loaded_time, loaded_date;
 };
 
 class AutoexecEditor;
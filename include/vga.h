@@ -24,10 +24,16 @@
 #include "dosbox.h"
 #endif
 
-//Don't enable keeping changes and mapping lfb probably...
+//Changes are only used to skip lines in modes whose writes all go through
+//a tracking handler. With both defined the lfb and svga banks stay mapped,
+//but every page takes one tracked write per frame before it is writable.
 #define VGA_LFB_MAPPED
-//#define VGA_KEEP_CHANGES
+#define VGA_KEEP_CHANGES
 #define VGA_CHANGE_SHIFT	9
+#define VGA_CHANGE_PAGES	1024
+//Per line drawing modes render their lines in one batch at the end of the
+//frame, register writes that change the picture draw the passed lines first.
+#define VGA_BATCH_LINES
 
 class PageHandler;
 
@@ -148,6 +154,7 @@ typedef struct {
 		double vdend, vtotal;
 		double hdend, htotal;
 		double parts;
+		double linestart;			// Absolute time of the first line
 	} delay;
 	Bitu bpp;
 	double aspect_ratio;
@@ -167,6 +174,7 @@ typedef struct {
 	Drawmode mode;
 	bool vret_triggered;
 	bool vga_override;
+	bool batch_pending;
 } VGA_Draw;
 
 typedef struct {
@@ -365,12 +373,18 @@ typedef struct {
 
 typedef struct {
 	//Add a few more just to be safe
-	Bit8u*	map; /* allocated dynamically: [(VGA_MEMORY >> VGA_CHANGE_SHIFT) + 32] */
+	Bit8u*	map; /* allocated dynamically: [mapMask + 1 + 32], covers fastmem */
+	Bit32u	mapMask;
 	Bit8u	checkMask, frame, writeMask;
 	bool	active;
 	Bit32u  clearMask;
 	Bit32u	start, last;
-	Bit32u	lastAddress;
+	Bit32u	lastAddress, lastLinearMask;
+	Bit8u*	lastLinearBase;
+	Bit32u	skipped, drawn;	/* scanlines left out/converted while tracking */
+	Bit32u	mapped[VGA_CHANGE_PAGES];	/* linear pages made writable this frame */
+	PageHandler * mappedHandler[VGA_CHANGE_PAGES];
+	Bitu	mappedUsed;
 } VGA_Changes;
 
 typedef struct {
@@ -447,6 +461,7 @@ void VGA_SetClock(Bitu which,Bitu target);
 void VGA_DACSetEntirePalette(void);
 void VGA_StartRetrace(void);
 void VGA_StartUpdateLFB(void);
+void VGA_ProtectChanges(void);
 void VGA_SetBlinking(Bitu enabled);
 void VGA_SetCGA2Table(Bit8u val0,Bit8u val1);
 void VGA_SetCGA4Table(Bit8u val0,Bit8u val1,Bit8u val2,Bit8u val3);
@@ -457,6 +472,15 @@ void VGA_SetOverride(bool vga_override);
 
 extern VGA_Type vga;
 
+#ifdef VGA_BATCH_LINES
+void VGA_DrawPendingLines(void);
+static inline void VGA_RasterWrite(void) {
+	if (vga.draw.batch_pending) VGA_DrawPendingLines();
+}
+#else
+static inline void VGA_RasterWrite(void) {}
+#endif
+
 /* Support for modular SVGA implementation */
 /* Video mode extra data to be passed to FinishSetMode_SVGA().
    This structure will be in flux until all drivers (including S3)
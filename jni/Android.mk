@@ -15,6 +15,9 @@ else ifeq ($(TARGET_ARCH_ABI), x86_64)
     WITH_DYNAREC := x86_64
 endif
 
+WITH_NETWORK := 1
+WITH_OPL_THREAD := 1
+
 include $(CORE_DIR)/Makefile.common
 
 COMMONFLAGS += -D__LIBRETRO__ -DFRONTEND_SUPPORTS_RGB565 $(INCFLAGS) -DC_HAVE_MPROTECT="1"
@@ -0,0 +1,638 @@
+/*
+ *  Copyright (C) 2002-2013  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#include "dosbox.h"
+
+#if C_IPX || C_MODEM
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "SDL_net.h"
+
+#if defined(__linux__) && (!defined(__ANDROID__) || __ANDROID_API__ >= 21)
+#define HAVE_RECVMMSG 1
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+// Same layout as _TCPsocketX in misc_util.cpp. Streams never block, a
+// connect() finishes and queued data drains from SDLNet_CheckSockets.
+struct _TCPsocket {
+    int ready;
+    int channel;
+    IPaddress remoteAddress;
+    IPaddress localAddress;
+    int sflag;
+    int connecting;
+    int pending;
+    Uint8 sendbuf[SDLNET_TCP_SENDBUF];
+};
+
+struct _UDPsocket {
+    int ready;
+    int channel;
+    IPaddress address;
+    IPaddress binding[SDLNET_MAX_UDPCHANNELS];
+    bool bound[SDLNET_MAX_UDPCHANNELS];
+
+    // Received datagrams not yet handed out by SDLNet_UDP_Recv. The buffers
+    // live in the socket so the receive path does not allocate.
+    int rx_head;
+    int rx_count;
+    int rx_len[SDLNET_UDP_BATCH];
+    sockaddr_in rx_from[SDLNET_UDP_BATCH];
+    Uint8 rx_data[SDLNET_UDP_BATCH][SDLNET_UDP_MAXPACKET];
+#ifdef HAVE_RECVMMSG
+    mmsghdr rx_msg[SDLNET_UDP_BATCH];
+    iovec rx_iov[SDLNET_UDP_BATCH];
+#endif
+};
+
+struct _SDLNet_SocketSet {
+    int numsockets;
+    int maxsockets;
+    SDLNet_GenericSocket *sockets;
+    bool *tcp;
+    pollfd *fds;
+};
+
+static char net_error[256];
+
+static void SDLNet_SetError(const char *what)
+{
+    snprintf(net_error, sizeof(net_error), "%s: %s", what, strerror(errno));
+}
+
+static bool SDLNet_SetNonBlocking(int fd, bool on)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0)
+        return false;
+    flags = on ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+    return fcntl(fd, F_SETFL, flags) == 0;
+}
+
+static void SDLNet_NoSigPipe(int fd)
+{
+#ifdef SO_NOSIGPIPE
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#else
+    (void)fd;
+#endif
+}
+
+static void SDLNet_ToSockaddr(const IPaddress *ip, sockaddr_in *sa)
+{
+    memset(sa, 0, sizeof(*sa));
+    sa->sin_family = AF_INET;
+    sa->sin_addr.s_addr = ip->host;
+    sa->sin_port = ip->port;
+}
+
+int SDLNet_Init(void)
+{
+    net_error[0] = 0;
+    return 0;
+}
+
+void SDLNet_Quit(void)
+{
+}
+
+const char *SDLNet_GetError(void)
+{
+    return net_error;
+}
+
+int SDLNet_ResolveHost(IPaddress *address, const char *host, Uint16 port)
+{
+    address->port = htons(port);
+    if (host == NULL) {
+        address->host = INADDR_ANY;
+        return 0;
+    }
+
+    in_addr addr;
+    if (inet_pton(AF_INET, host, &addr) == 1) {
+        address->host = addr.s_addr;
+        return 0;
+    }
+
+    addrinfo hints;
+    addrinfo *res = NULL;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    int err = getaddrinfo(host, NULL, &hints, &res);
+    if (err != 0 || res == NULL) {
+        snprintf(net_error, sizeof(net_error), "Couldn't resolve %s: %s", host, gai_strerror(err));
+        address->host = INADDR_NONE;
+        return -1;
+    }
+    address->host = ((sockaddr_in *)res->ai_addr)->sin_addr.s_addr;
+    freeaddrinfo(res);
+    return 0;
+}
+
+/* TCP */
+
+TCPsocket SDLNet_TCP_Open(IPaddress *ip)
+{
+    TCPsocket sock = (TCPsocket)calloc(1, sizeof(struct _TCPsocket));
+    if (!sock) {
+        snprintf(net_error, sizeof(net_error), "Out of memory");
+        return NULL;
+    }
+
+    sock->channel = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock->channel < 0) {
+        SDLNet_SetError("Couldn't create socket");
+        free(sock);
+        return NULL;
+    }
+    SDLNet_NoSigPipe(sock->channel);
+
+    sockaddr_in sa;
+    SDLNet_ToSockaddr(ip, &sa);
+
+    if (ip->host == INADDR_ANY || ip->host == INADDR_NONE) {
+        // Listening socket, accept() must never stall the emulation
+        int one = 1;
+        sa.sin_addr.s_addr = INADDR_ANY;
+        setsockopt(sock->channel, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (bind(sock->channel, (sockaddr *)&sa, sizeof(sa)) < 0) {
+            SDLNet_SetError("Couldn't bind to local port");
+            goto error;
+        }
+        if (listen(sock->channel, 5) < 0) {
+            SDLNet_SetError("Couldn't listen to local port");
+            goto error;
+        }
+        SDLNet_SetNonBlocking(sock->channel, true);
+        sock->sflag = 1;
+    } else {
+        // A host that does not answer must not stall the emulation until
+        // the SYN timeout, SDLNet_CheckSockets picks up the result
+        SDLNet_SetNonBlocking(sock->channel, true);
+        if (connect(sock->channel, (sockaddr *)&sa, sizeof(sa)) < 0) {
+            if (errno != EINPROGRESS) {
+                SDLNet_SetError("Couldn't connect to remote host");
+                goto error;
+            }
+            sock->connecting = 1;
+        }
+        int one = 1;
+        setsockopt(sock->channel, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        sock->sflag = 0;
+    }
+
+    sock->remoteAddress = *ip;
+    {
+        socklen_t len = sizeof(sa);
+        if (getsockname(sock->channel, (sockaddr *)&sa, &len) == 0) {
+            sock->localAddress.host = sa.sin_addr.s_addr;
+            sock->localAddress.port = sa.sin_port;
+        }
+    }
+    return sock;
+
+error:
+    close(sock->channel);
+    free(sock);
+    return NULL;
+}
+
+TCPsocket SDLNet_TCP_Accept(TCPsocket server)
+{
+    if (!server->sflag) {
+        snprintf(net_error, sizeof(net_error), "Only server sockets can accept()");
+        return NULL;
+    }
+    server->ready = 0;
+
+    sockaddr_in sa;
+    socklen_t len = sizeof(sa);
+    int fd = accept(server->channel, (sockaddr *)&sa, &len);
+    if (fd < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+            SDLNet_SetError("accept() failed");
+        return NULL;
+    }
+
+    TCPsocket sock = (TCPsocket)calloc(1, sizeof(struct _TCPsocket));
+    if (!sock) {
+        close(fd);
+        snprintf(net_error, sizeof(net_error), "Out of memory");
+        return NULL;
+    }
+    // Only BSD hands the listener's O_NONBLOCK on to accepted sockets
+    SDLNet_SetNonBlocking(fd, true);
+    SDLNet_NoSigPipe(fd);
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    sock->channel = fd;
+    sock->remoteAddress.host = sa.sin_addr.s_addr;
+    sock->remoteAddress.port = sa.sin_port;
+    sock->localAddress = server->localAddress;
+    return sock;
+}
+
+IPaddress *SDLNet_TCP_GetPeerAddress(TCPsocket sock)
+{
+    if (sock->sflag)
+        return NULL;
+    return &sock->remoteAddress;
+}
+
+// Hand queued data to the kernel as far as it takes it, false once the
+// connection is broken
+static bool SDLNet_TCP_Flush(TCPsocket sock)
+{
+    while (sock->pending && !sock->connecting) {
+        ssize_t n = send(sock->channel, sock->sendbuf, sock->pending, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return true;
+            SDLNet_SetError("send() failed");
+            return false;
+        }
+        memmove(sock->sendbuf, sock->sendbuf + n, sock->pending - n);
+        sock->pending -= (int)n;
+    }
+    return true;
+}
+
+int SDLNet_TCP_Send(TCPsocket sock, const void *datap, int len)
+{
+    const Uint8 *data = (const Uint8 *)datap;
+    int sent = 0;
+
+    if (sock->sflag) {
+        snprintf(net_error, sizeof(net_error), "Server sockets cannot send");
+        return -1;
+    }
+    if (!SDLNet_TCP_Flush(sock))
+        return -1;
+    // Nothing goes out directly while older data waits, that keeps the order
+    while (!sock->pending && !sock->connecting && sent < len) {
+        ssize_t n = send(sock->channel, data + sent, len - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            SDLNet_SetError("send() failed");
+            return sent;
+        }
+        sent += (int)n;
+    }
+    // Queue what the kernel did not take, a peer that stops reading for
+    // longer than the buffer lasts gets a short count
+    int queue = len - sent;
+    if (queue > SDLNET_TCP_SENDBUF - sock->pending) {
+        queue = SDLNET_TCP_SENDBUF - sock->pending;
+        snprintf(net_error, sizeof(net_error), "Send buffer full");
+    }
+    memcpy(sock->sendbuf + sock->pending, data + sent, queue);
+    sock->pending += queue;
+    return sent + queue;
+}
+
+int SDLNet_TCP_Recv(TCPsocket sock, void *data, int maxlen)
+{
+    ssize_t n;
+
+    if (sock->sflag) {
+        snprintf(net_error, sizeof(net_error), "Server sockets cannot receive");
+        return -1;
+    }
+    do {
+        n = recv(sock->channel, data, maxlen, MSG_DONTWAIT);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0)
+        SDLNet_SetError("recv() failed");
+    sock->ready = 0;
+    return (int)n;
+}
+
+void SDLNet_TCP_Close(TCPsocket sock)
+{
+    if (!sock)
+        return;
+    if (sock->channel >= 0) {
+        SDLNet_TCP_Flush(sock);
+        close(sock->channel);
+    }
+    free(sock);
+}
+
+/* UDP */
+
+UDPsocket SDLNet_UDP_Open(Uint16 port)
+{
+    UDPsocket sock = (UDPsocket)calloc(1, sizeof(struct _UDPsocket));
+    if (!sock) {
+        snprintf(net_error, sizeof(net_error), "Out of memory");
+        return NULL;
+    }
+
+    sock->channel = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock->channel < 0) {
+        SDLNet_SetError("Couldn't create socket");
+        free(sock);
+        return NULL;
+    }
+
+    sockaddr_in sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_addr.s_addr = INADDR_ANY;
+    sa.sin_port = htons(port);
+    if (bind(sock->channel, (sockaddr *)&sa, sizeof(sa)) < 0) {
+        SDLNet_SetError("Couldn't bind to local port");
+        close(sock->channel);
+        free(sock);
+        return NULL;
+    }
+    SDLNet_SetNonBlocking(sock->channel, true);
+
+    socklen_t len = sizeof(sa);
+    if (getsockname(sock->channel, (sockaddr *)&sa, &len) == 0) {
+        sock->address.host = sa.sin_addr.s_addr;
+        sock->address.port = sa.sin_port;
+    }
+
+#ifdef HAVE_RECVMMSG
+    for (int i = 0; i < SDLNET_UDP_BATCH; i++) {
+        sock->rx_iov[i].iov_base = sock->rx_data[i];
+        sock->rx_iov[i].iov_len = SDLNET_UDP_MAXPACKET;
+        sock->rx_msg[i].msg_hdr.msg_iov = &sock->rx_iov[i];
+        sock->rx_msg[i].msg_hdr.msg_iovlen = 1;
+        sock->rx_msg[i].msg_hdr.msg_name = &sock->rx_from[i];
+    }
+#endif
+    return sock;
+}
+
+int SDLNet_UDP_Bind(UDPsocket sock, int channel, const IPaddress *address)
+{
+    if (channel == -1) {
+        for (channel = 0; channel < SDLNET_MAX_UDPCHANNELS; channel++)
+            if (!sock->bound[channel])
+                break;
+    }
+    if (channel < 0 || channel >= SDLNET_MAX_UDPCHANNELS) {
+        snprintf(net_error, sizeof(net_error), "No free UDP channel");
+        return -1;
+    }
+    sock->binding[channel] = *address;
+    sock->bound[channel] = true;
+    return channel;
+}
+
+int SDLNet_UDP_Send(UDPsocket sock, int channel, UDPpacket *packet)
+{
+    const IPaddress *dest = &packet->address;
+    if (channel >= 0) {
+        if (channel >= SDLNET_MAX_UDPCHANNELS || !sock->bound[channel]) {
+            snprintf(net_error, sizeof(net_error), "Channel %d is not bound", channel);
+            return 0;
+        }
+        dest = &sock->binding[channel];
+    }
+
+    sockaddr_in sa;
+    SDLNet_ToSockaddr(dest, &sa);
+    ssize_t n;
+    do {
+        n = sendto(sock->channel, packet->data, packet->len, MSG_NOSIGNAL, (sockaddr *)&sa, sizeof(sa));
+    } while (n < 0 && errno == EINTR);
+    packet->status = (int)n;
+    if (n < 0) {
+        SDLNet_SetError("sendto() failed");
+        return 0;
+    }
+    return 1;
+}
+
+// Pull every pending datagram (up to SDLNET_UDP_BATCH) in one go
+static int SDLNet_UDP_Fill(UDPsocket sock)
+{
+    int n;
+    sock->rx_head = 0;
+    sock->rx_count = 0;
+#ifdef HAVE_RECVMMSG
+    for (int i = 0; i < SDLNET_UDP_BATCH; i++)
+        sock->rx_msg[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+    do {
+        n = recvmmsg(sock->channel, sock->rx_msg, SDLNET_UDP_BATCH, MSG_DONTWAIT, NULL);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0)
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    for (int i = 0; i < n; i++)
+        sock->rx_len[i] = (sock->rx_msg[i].msg_hdr.msg_flags & MSG_TRUNC) ? -1 : (int)sock->rx_msg[i].msg_len;
+#else
+    for (n = 0; n < SDLNET_UDP_BATCH; n++) {
+        socklen_t len = sizeof(sockaddr_in);
+        ssize_t r = recvfrom(sock->channel, sock->rx_data[n], SDLNET_UDP_MAXPACKET, MSG_DONTWAIT,
+                             (sockaddr *)&sock->rx_from[n], &len);
+        if (r < 0) {
+            if (errno == EINTR) {
+                n--;
+                continue;
+            }
+            if (n == 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+                return -1;
+            break;
+        }
+        sock->rx_len[n] = (int)r;
+    }
+#endif
+    sock->rx_count = n;
+    return n;
+}
+
+int SDLNet_UDP_Recv(UDPsocket sock, UDPpacket *packet)
+{
+    for (;;) {
+        if (sock->rx_head == sock->rx_count) {
+            int n = SDLNet_UDP_Fill(sock);
+            if (n < 0) {
+                SDLNet_SetError("recvfrom() failed");
+                return -1;
+            }
+            if (n == 0)
+                return 0;
+        }
+
+        int i = sock->rx_head++;
+        int len = sock->rx_len[i];
+        // Oversized datagrams were truncated by the kernel, drop them
+        if (len < 0 || len > packet->maxlen)
+            continue;
+
+        memcpy(packet->data, sock->rx_data[i], len);
+        packet->len = len;
+        packet->status = len;
+        packet->address.host = sock->rx_from[i].sin_addr.s_addr;
+        packet->address.port = sock->rx_from[i].sin_port;
+        packet->channel = -1;
+        for (int c = 0; c < SDLNET_MAX_UDPCHANNELS; c++) {
+            if (sock->bound[c] && sock->binding[c].host == packet->address.host &&
+                sock->binding[c].port == packet->address.port) {
+                packet->channel = c;
+                break;
+            }
+        }
+        return 1;
+    }
+}
+
+void SDLNet_UDP_Close(UDPsocket sock)
+{
+    if (!sock)
+        return;
+    if (sock->channel >= 0)
+        close(sock->channel);
+    free(sock);
+}
+
+/* Socket sets */
+
+SDLNet_SocketSet SDLNet_AllocSocketSet(int maxsockets)
+{
+    SDLNet_SocketSet set = (SDLNet_SocketSet)malloc(sizeof(struct _SDLNet_SocketSet) +
+        maxsockets * (sizeof(SDLNet_GenericSocket) + sizeof(pollfd) + sizeof(bool)));
+    if (!set) {
+        snprintf(net_error, sizeof(net_error), "Out of memory");
+        return NULL;
+    }
+    set->numsockets = 0;
+    set->maxsockets = maxsockets;
+    set->fds = (pollfd *)(set + 1);
+    set->sockets = (SDLNet_GenericSocket *)(set->fds + maxsockets);
+    set->tcp = (bool *)(set->sockets + maxsockets);
+    return set;
+}
+
+static int SDLNet_AddSocket(SDLNet_SocketSet set, SDLNet_GenericSocket sock, bool tcp)
+{
+    if (sock != NULL) {
+        if (set->numsockets == set->maxsockets) {
+            snprintf(net_error, sizeof(net_error), "socketset is full");
+            return -1;
+        }
+        set->tcp[set->numsockets] = tcp;
+        set->sockets[set->numsockets++] = sock;
+    }
+    return set->numsockets;
+}
+
+int SDLNet_AddSocket(SDLNet_SocketSet set, SDLNet_GenericSocket sock)
+{
+    return SDLNet_AddSocket(set, sock, false);
+}
+
+int SDLNet_TCP_AddSocket(SDLNet_SocketSet set, TCPsocket sock)
+{
+    return SDLNet_AddSocket(set, (SDLNet_GenericSocket)sock, !sock || !sock->sflag);
+}
+
+int SDLNet_DelSocket(SDLNet_SocketSet set, SDLNet_GenericSocket sock)
+{
+    if (sock != NULL) {
+        int i;
+        for (i = 0; i < set->numsockets; i++)
+            if (set->sockets[i] == sock)
+                break;
+        if (i == set->numsockets) {
+            snprintf(net_error, sizeof(net_error), "socket not found in socketset");
+            return -1;
+        }
+        set->numsockets--;
+        set->sockets[i] = set->sockets[set->numsockets];
+        set->tcp[i] = set->tcp[set->numsockets];
+    }
+    return set->numsockets;
+}
+
+int SDLNet_CheckSockets(SDLNet_SocketSet set, Uint32 timeout)
+{
+    for (int i = 0; i < set->numsockets; i++) {
+        set->fds[i].fd = set->sockets[i]->channel;
+        set->fds[i].events = POLLIN;
+        set->fds[i].revents = 0;
+        if (set->tcp[i]) {
+            TCPsocket sock = (TCPsocket)set->sockets[i];
+            if (sock->connecting || sock->pending)
+                set->fds[i].events |= POLLOUT;
+        }
+    }
+    int n;
+    do {
+        n = poll(set->fds, set->numsockets, (int)timeout);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+        SDLNet_SetError("poll() failed");
+        return -1;
+    }
+    int ready = 0;
+    for (int i = 0; i < set->numsockets; i++) {
+        bool readable = (set->fds[i].revents & (POLLIN | POLLHUP | POLLERR)) != 0;
+        if (set->tcp[i]) {
+            TCPsocket sock = (TCPsocket)set->sockets[i];
+            // A failed connect() shows up as POLLERR and is reported by recv()
+            if (sock->connecting && (set->fds[i].revents & POLLOUT)) {
+                int err = 0;
+                socklen_t len = sizeof(err);
+                if (getsockopt(sock->channel, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && err == 0)
+                    sock->connecting = 0;
+            }
+            if (!SDLNet_TCP_Flush(sock))
+                readable = true;
+        }
+        set->sockets[i]->ready = readable;
+        if (readable)
+            ready++;
+    }
+    return ready;
+}
+
+void SDLNet_FreeSocketSet(SDLNet_SocketSet set)
+{
+    free(set);
+}
+
+#endif // C_IPX || C_MODEM
@@ -58,12 +58,15 @@ void LOG_StartUp(void);
 void MEM_Init(Section *);
 void PAGING_Init(Section *);
 void IO_Init(Section *);
+void IO_Change_Config(Section *);
+void IOSTAT_Init(Section *);
 void CALLBACK_Init(Section*);
 void PROGRAMS_Init(Section*);
 void RENDER_Init(Section*);
 void VGA_Init(Section*);
 void DOS_Init(Section*);
 void CPU_Init(Section*);
+void CPU_Change_Config(Section*);
 #if C_FPU
 void FPU_Init(Section*);
 #endif
@@ -400,6 +403,10 @@ void DOSBOX_Init(void) {
     printf("[DOSBOX_INIT] PIC_Init completed\n");
     secprop->AddInitFunction(&PROGRAMS_Init, true);
     printf("[DOSBOX_INIT] PROGRAMS_Init completed\n");
+    secprop->AddInitFunction(&IOSTAT_Init, true);
+    Pbool = secprop->Add_bool("ioprofile", Property::Changeable::Always, false);
+    Pbool->Set_change_function(&IO_Change_Config);
+    Pbool->Set_help("Count I/O port accesses and time their handlers, see IOSTAT.COM.");
     secprop->AddInitFunction(&TIMER_Init, true);
     printf("[DOSBOX_INIT] TIMER_Init completed\n");
     secprop->AddInitFunction(&CMOS_Init, true);
@@ -439,13 +446,21 @@ void DOSBOX_Init(void) {
         "normal", "simple", 0 };
     Pstring = secprop->Add_string("core", Property::Changeable::WhenIdle, "auto");
     Pstring->Set_values(cores);
+    Pstring->Set_change_function(&CPU_Change_Config);
     Pstring->Set_help("CPU Core used in emulation. auto will switch to dynamic if available and\n"
                       "appropriate.");
+#if (C_DYNREC)
+    Pstring = secprop->Add_path("dynamic_cache", Property::Changeable::OnlyAtStart, "");
+    Pstring->Set_help("File that keeps the translations of the dynamic core between runs, so the\n"
+                      "same programs start without translating their code again. Empty disables it.");
+#endif
     const char* cputype_values[] = { "auto", "386", "386_slow", "486", "486_slow", "pentium_slow", "pentium", "pentium_mmx", "386_prefetch", 0};
     Pstring = secprop->Add_string("cputype", Property::Changeable::Always, "auto");
     Pstring->Set_values(cputype_values);
+    Pstring->Set_change_function(&CPU_Change_Config);
     Pstring->Set_help("CPU Type used in emulation. auto is the fastest choice.");
     Pmulti_remain = secprop->Add_multiremain("cycles", Property::Changeable::Always, " ");
+    Pmulti_remain->Set_change_function(&CPU_Change_Config);
     Pmulti_remain->Set_help(
         "Amount of instructions DOSBox tries to emulate each millisecond.\n"
         "Setting this value too high results in sound dropouts and lags.\n"
@@ -462,9 +477,11 @@ void DOSBOX_Init(void) {
     Pstring->Set_values(cyclest);
     Pstring = Pmulti_remain->GetSection()->Add_string("parameters", Property::Changeable::Always, "");
     Pint = secprop->Add_int("cycleup", Property::Changeable::Always, 10);
+    Pint->Set_change_function(&CPU_Change_Config);
     Pint->SetMinMax(1, 1000000);
     Pint->Set_help("Amount of cycles to decrease/increase with keycombos.(CTRL-F11/CTRL-F12)");
     Pint = secprop->Add_int("cycledown", Property::Changeable::Always, 20);
+    Pint->Set_change_function(&CPU_Change_Config);
     Pint->SetMinMax(1, 1000000);
     Pint->Set_help("Setting it lower than 100 will be a percentage.");
     printf("[DOSBOX_INIT] Added cpu section with CPU_Init\n");
@@ -699,6 +716,9 @@ void DOSBOX_Init(void) {
     secprop->AddInitFunction(&MSCDEX_Init, true);
     secprop->AddInitFunction(&DRIVES_Init, true);
     secprop->AddInitFunction(&CDROM_Image_Init, true);
+    Pint = secprop->Add_int("cdcache", Property::Changeable::WhenIdle, 1024);
+    Pint->SetMinMax(0, 65536);
+    Pint->Set_help("Size in KB of the sector cache for mounted CD images, 0 disables it.");
     printf("[DOSBOX_INIT] Added dos section with DOS_Init, XMS_Init, EMS_Init, DOS_KeyboardLayout_Init, MSCDEX_Init, DRIVES_Init, CDROM_Image_Init\n");
 
 #if C_IPX
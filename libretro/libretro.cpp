@@ -125,6 +125,11 @@ void retro_set_audio_sample_batch(retro_audio_sample_batch_t cb) { audio_batch_c
 void retro_set_input_poll(retro_input_poll_t cb) { poll_cb = cb; }
 void retro_set_input_state(retro_input_state_t cb) { input_cb = cb; }
 
+// Changed options are collected per section while check_variables runs and
+// applied together by apply_dosbox_variables, so a section is reinitialised at
+// most once and properties with a change function not at all.
+static std::vector<std::pair<Section_prop*, std::vector<std::pair<std::string, std::string>>>> pending_variables;
+
 bool update_dosbox_variable(std::string_view section, std::string_view var, std::string_view val) noexcept {
     printf("[LIBRETRO] update_dosbox_variable: section=%s, var=%s, value=%s\n",
            std::string(section).c_str(), std::string(var).c_str(), std::string(val).c_str());
@@ -133,22 +138,39 @@ bool update_dosbox_variable(std::string_view section, std::string_view var, std:
         if (log_cb) log_cb(RETRO_LOG_ERROR, "[LIBRETRO] update_dosbox_variable: control is null\n");
         return false;
     }
-    if (log_cb) {
-        log_cb(RETRO_LOG_INFO, "[LIBRETRO] update_dosbox_variable: section=%s, var=%s, value=%s\n",
-               std::string(section).c_str(), std::string(var).c_str(), std::string(val).c_str());
-    }
     if (Section* section_ptr = control->GetSection(std::string{section}); section_ptr) {
         if (Section_prop* secprop = dynamic_cast<Section_prop*>(section_ptr)) {
-            section_ptr->ExecuteDestroy(false);
-            std::string inputline = std::string{var} + '=' + std::string{val};
-            bool result = section_ptr->HandleInputline(inputline.c_str());
-            section_ptr->ExecuteInit(false);
-            printf("[LIBRETRO] update_dosbox_variable: %s %s\n", inputline.c_str(), result ? "success" : "failed");
-            if (log_cb) {
-                log_cb(RETRO_LOG_INFO, "[LIBRETRO] update_dosbox_variable: %s %s\n",
-                       inputline.c_str(), result ? "success" : "failed");
+            Property* prop = secprop->Get_prop(std::string{var});
+            if (!prop) {
+                printf("[LIBRETRO] update_dosbox_variable: Property %s not found in %s\n",
+                       std::string(var).c_str(), std::string(section).c_str());
+                if (log_cb) {
+                    log_cb(RETRO_LOG_ERROR, "[LIBRETRO] update_dosbox_variable: Property %s not found in %s\n",
+                           std::string(var).c_str(), std::string(section).c_str());
+                }
+                return false;
+            }
+            if (prop->GetValue().ToString() == val) {
+                return true;
+            }
+            // Reject bad values here, the batch applied later can't report them
+            if (!prop->CheckString(std::string{val})) {
+                printf("[LIBRETRO] update_dosbox_variable: Invalid value %s for %s\n",
+                       std::string(val).c_str(), std::string(var).c_str());
+                if (log_cb) {
+                    log_cb(RETRO_LOG_ERROR, "[LIBRETRO] update_dosbox_variable: Invalid value %s for %s\n",
+                           std::string(val).c_str(), std::string(var).c_str());
+                }
+                return false;
+            }
+            auto it = std::find_if(pending_variables.begin(), pending_variables.end(),
+                                   [secprop](const auto& pending) { return pending.first == secprop; });
+            if (it == pending_variables.end()) {
+                it = pending_variables.emplace(pending_variables.end(), secprop,
+                                               std::vector<std::pair<std::string, std::string>>{});
             }
-            return result;
+            it->second.emplace_back(std::string{var}, std::string{val});
+            return true;
         } else {
             printf("[LIBRETRO] update_dosbox_variable: Section %s is not a Section_prop\n",
                    std::string(section).c_str());
@@ -168,6 +190,19 @@ bool update_dosbox_variable(std::string_view section, std::string_view var, std:
     return false;
 }
 
+void apply_dosbox_variables() noexcept {
+    for (const auto& [secprop, values] : pending_variables) {
+        bool result = secprop->ApplyValues(values);
+        printf("[LIBRETRO] apply_dosbox_variables: %s, %zu values %s\n",
+               secprop->GetName(), values.size(), result ? "success" : "failed");
+        if (log_cb) {
+            log_cb(RETRO_LOG_INFO, "[LIBRETRO] apply_dosbox_variables: %s, %zu values %s\n",
+                   secprop->GetName(), values.size(), result ? "success" : "failed");
+        }
+    }
+    pending_variables.clear();
+}
+
 static const retro_variable vars[] = {
     {"dosbox_use_options", "Enable core-options; true|false"},
     {"dosbox_adv_options", "Enable advanced core-options; false|true"},
@@ -487,6 +522,8 @@ void check_variables() noexcept {
         }
     }
 
+    apply_dosbox_variables();
+
     if (!handlers_added) {
         printf("[LIBRETRO] No mapper handlers defined, skipping registration\n");
         if (log_cb) log_cb(RETRO_LOG_WARN, "[LIBRETRO] No mapper handlers defined, skipping registration\n");
@@ -498,7 +535,7 @@ void check_variables() noexcept {
 void leave_thread(Bitu /*unused*/) noexcept {
     MIXER_CallBack(nullptr, audioData.data(), samplesPerFrame * 4);
     co_switch(mainThread);
-    PIC_AddEvent(leave_thread, 1000.0f / 60.0f, 0);
+    PIC_AddEvent(leave_thread, RETRO_FRAME_TIME, 0);
 }
 
 void start_dosbox() {
@@ -541,7 +578,7 @@ void start_dosbox() {
 
     check_variables();
     co_switch(mainThread);
-    PIC_AddEvent(leave_thread, 1000.0f / 60.0f, 0);
+    PIC_AddEvent(leave_thread, RETRO_FRAME_TIME, 0);
 
     try {
         printf("[LIBRETRO] Starting DOS shell\n");
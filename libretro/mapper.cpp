@@ -1,4 +1,6 @@
 #include <vector>
+#include <deque>
+#include <chrono>
 #include <stdio.h>
 
 #include "libretro.h"
@@ -9,6 +11,7 @@
 #include "keyboard.h"
 #include "mouse.h"
 #include "joystick.h"
+#include "pic.h"
 #include <string.h>
 #include <stdlib.h>
 
@@ -74,6 +77,15 @@ static const unsigned eventKeyMap[] =
 static const unsigned eventMOD1 = 55;
 static const unsigned eventMOD2 = 53;
 
+struct Processable
+{
+    virtual void process() = 0;
+    virtual void press() const {}
+    virtual void release() const {}
+};
+
+static void MAPPER_QueueItem(const Processable* item, bool down);
+
 template<typename T>
 struct InputItem
 {
@@ -83,17 +95,12 @@ struct InputItem
 
     void process(const T& aItem, bool aDownNow)
     {
-        if(aDownNow && !down)          aItem.press();
-        else if(!aDownNow && down)     aItem.release();
+        if(aDownNow != down)
+            MAPPER_QueueItem(&aItem, aDownNow);
         down = aDownNow;
     }
 };
 
-struct Processable
-{
-    virtual void process() = 0;
-};
-
 struct EventHandler : public Processable
 {
 
@@ -236,6 +243,62 @@ struct JoystickHat : public Processable
 };
 
 
+// Input is replayed through the PIC during the next emulated frame. Every
+// key, button and motion goes through one queue in arrival order, the first
+// one is applied right away and the rest keep their host spacing after it.
+typedef std::chrono::steady_clock InputClock;
+
+struct InputEvent
+{
+    enum { KEY, ITEM, MOTION } type;
+    bool down;
+    KBD_KEYS key;
+    const Processable* item;
+    float x, y;
+    InputClock::time_point time;
+};
+static std::deque<InputEvent> inputEvents;
+static size_t inputScheduled;
+
+static void MAPPER_ApplyEvent(const InputEvent& event)
+{
+    switch (event.type)
+    {
+        case InputEvent::KEY:
+            KEYBOARD_AddKey(event.key, event.down);
+            break;
+        case InputEvent::ITEM:
+            if (event.down) event.item->press();
+            else            event.item->release();
+            break;
+        case InputEvent::MOTION:
+            Mouse_CursorMoved(event.x, event.y, 0, 0, true);
+            break;
+    }
+}
+
+// Events are scheduled in queue order, so each one applies the oldest
+static void MAPPER_InputEvent(Bitu /*val*/)
+{
+    if (!inputScheduled)
+        return;
+    MAPPER_ApplyEvent(inputEvents.front());
+    inputEvents.pop_front();
+    inputScheduled--;
+}
+
+static void MAPPER_QueueEvent(InputEvent& event)
+{
+    event.time = InputClock::now();
+    inputEvents.push_back(event);
+}
+
+static void MAPPER_QueueItem(const Processable* item, bool down)
+{
+    InputEvent event = { InputEvent::ITEM, down, KBD_NONE, item, 0, 0 };
+    MAPPER_QueueEvent(event);
+}
+
 void keyboard_event(bool down, unsigned keycode, uint32_t character, uint16_t key_modifiers)
 {
     for (int i = 0; keyMap[i].retroID; i ++)
@@ -246,7 +309,8 @@ void keyboard_event(bool down, unsigned keycode, uint32_t character, uint16_t ke
                 return;
 
             keyboardState[keyMap[i].dosboxID] = down;
-            KEYBOARD_AddKey(keyMap[i].dosboxID, down);
+            InputEvent event = { InputEvent::KEY, down, keyMap[i].dosboxID, 0, 0, 0 };
+            MAPPER_QueueEvent(event);
             return;
         }
     }
@@ -541,6 +605,17 @@ void MAPPER_Run(bool pressed)
 {
     poll_cb();
 
+    // Whatever the last frame did not get to is applied before the new input
+    if (inputScheduled)
+    {
+        PIC_RemoveEvents(MAPPER_InputEvent);
+        for (; inputScheduled; inputScheduled--)
+        {
+            MAPPER_ApplyEvent(inputEvents.front());
+            inputEvents.pop_front();
+        }
+    }
+
     // Mouse movement
     int16_t mouseX = input_cb(0, RDEV(MOUSE), 0, RDID(MOUSE_X));
     int16_t mouseY = input_cb(0, RDEV(MOUSE), 0, RDID(MOUSE_Y));
@@ -560,12 +635,26 @@ void MAPPER_Run(bool pressed)
        emulated_mouseX = emulated_mouseX * speed / 32768;
        emulated_mouseY = emulated_mouseY * speed / 32768;
 
-        Mouse_CursorMoved(emulated_mouseX, emulated_mouseY, 0, 0, true);
+        mouseX += emulated_mouseX;
+        mouseY += emulated_mouseY;
+    }
+    if (mouseX || mouseY)
+    {
+        InputEvent event = { InputEvent::MOTION, false, KBD_NONE, 0, (float)mouseX, (float)mouseY };
+        MAPPER_QueueEvent(event);
     }
-    if(mouseX || mouseY)
-        Mouse_CursorMoved(mouseX, mouseY, 0, 0, true);
     for (std::vector<Processable*>::iterator i = inputList.begin(); i != inputList.end(); i ++)
         (*i)->process();
+
+    if (inputEvents.empty())
+        return;
+    // Host spacing is kept as long as it fits into one emulated frame
+    const InputClock::time_point first = inputEvents.front().time;
+    const float span = std::chrono::duration<float, std::milli>(inputEvents.back().time - first).count();
+    const float scale = span > RETRO_FRAME_TIME ? RETRO_FRAME_TIME / span : 1.0f;
+    for (std::deque<InputEvent>::const_iterator i = inputEvents.begin(); i != inputEvents.end(); i ++)
+        PIC_AddEvent(MAPPER_InputEvent, std::chrono::duration<float, std::milli>(i->time - first).count() * scale);
+    inputScheduled = inputEvents.size();
 }
 
 void Mouse_AutoLock(bool enable){ return; };
\ No newline at end of file
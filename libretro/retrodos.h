@@ -6,6 +6,9 @@
 
 # define RETROLOG(msg) printf("%s\n", msg)
 
+/* Emulated time between two returns to the frontend, in ms */
+# define RETRO_FRAME_TIME (1000.0f / 60.0f)
+
 extern retro_video_refresh_t video_cb;
 extern retro_audio_sample_batch_t audio_batch_cb;
 extern retro_input_poll_t poll_cb;
@@ -25,6 +25,7 @@
 #include "callback.h"
 #include "mem.h"
 #include "cpu.h"
+#include "pic.h"
 
 /* CallBack are located at 0xF000:0x1000  (see CB_SEG and CB_SOFFSET in callback.h)
    And they are 16 bytes each and you can define them to behave in certain ways like a
@@ -74,6 +75,25 @@ void CALLBACK_Idle(void) {
 		CPU_Cycles=0;
 }
 
+/* Input polls that found nothing within one tick before the program counts as idle */
+#define CB_IDLE_POLLS 8
+
+/* Called by BIOS and DOS services when a program polls for input and none is
+ * there. Once a program keeps polling in the same tick, the rest of the cpu
+ * slice is skipped like HLT does, so emulated time moves on to the next PIC
+ * event instead of running the polling loop. */
+void CALLBACK_IdlePoll(void) {
+	static Bitu idle_tick=0;
+	static Bitu idle_polls=0;
+	if (idle_tick!=PIC_Ticks) {
+		idle_tick=PIC_Ticks;
+		idle_polls=0;
+	}
+	if (++idle_polls<CB_IDLE_POLLS || CPU_Cycles<=0) return;
+	CPU_IODelayRemoved+=CPU_Cycles;
+	CPU_Cycles=0;
+}
+
 static Bitu default_handler(void) {
 	LOG(LOG_CPU,LOG_ERROR)("Illegal Unhandled Interrupt Called %X",lastint);
 	return CBRET_NONE;
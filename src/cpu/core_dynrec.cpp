@@ -51,19 +51,14 @@
 #include "lazyflags.h"
 #include "pic.h"
 
-// Cache parameters optimized for balance between speed and timing accuracy
-#define CACHE_MAXSIZE   (8192)          // Max block size for efficient execution
-#define CACHE_TOTAL     (1024*1024*12)  // 12MB total cache, balanced for modern systems
-#define CACHE_PAGES     (768)           // Reduced from 1024 for interrupt checks
-#define CACHE_BLOCKS    (192*1024)      // Compromise between 128K and 256K
-#define CACHE_ALIGN     (64)            // Cache line alignment for performance
-#define DYN_HASH_SHIFT  (3)             // 512 hash entries for fast lookups
+#define CACHE_MAXSIZE   (4096*2)
+#define CACHE_TOTAL     (1024*1024*8)
+#define CACHE_PAGES     (512)
+#define CACHE_BLOCKS    (128*1024)
+#define CACHE_ALIGN     (16)
+#define DYN_HASH_SHIFT  (5)
 #define DYN_PAGE_HASH   (4096>>DYN_HASH_SHIFT)
-#define DYN_LINKS       (24)            // Balanced linking for speed and interrupts
-
-// Link cache for fast block transitions
-#define LINK_CACHE_SIZE 48              // Reduced for interrupt frequency
-static std::array<CacheBlockDynRec*, LINK_CACHE_SIZE> link_cache{};
+#define DYN_LINKS       (16)
 
 #if C_FPU
 #define CPU_FPU 1
@@ -126,7 +121,6 @@ static struct CoreDynrec {
 #define MIPSEL      0x03
 #define ARMV4LE     0x04
 #define ARMV7LE     0x05
-#define POWERPC     0x04
 
 #if C_TARGETCPU == X86_64
 #include "core_dynrec/risc_x64.h"
@@ -136,266 +130,174 @@ static struct CoreDynrec {
 #include "core_dynrec/risc_mipsel32.h"
 #elif (C_TARGETCPU == ARMV4LE) || (C_TARGETCPU == ARMV7LE)
 #include "core_dynrec/risc_armv4le.h"
-#elif C_TARGETCPU == POWERPC
-#include "core_dynrec/risc_ppc.h"
+#else
+#error "core_dynrec has no backend for this C_TARGETCPU"
 #endif
 
 #include "core_dynrec/decoder.h"
+#include "core_dynrec/cache_file.h"
 
-// Block linking with timing-aware cache
+// Link the block that just ran to the block at CS:EIP if that one has been
+// translated already, later runs then jump there without leaving the code
 static CacheBlockDynRec* LinkBlocks(BlockReturn ret) {
-    printf("[CORE_DYNREC] LinkBlocks: Entering, ret=%d\n", static_cast<int>(ret));
-    CacheBlockDynRec* block = nullptr;
-    const Bitu temp_ip = SegPhys(cs) + reg_eip;
-    const Bitu link_hash = (temp_ip >> 3) & (LINK_CACHE_SIZE - 1);
-
-    printf("[CORE_DYNREC] LinkBlocks: ret=%d, temp_ip=0x%lx, link_hash=0x%lx\n", 
-           static_cast<int>(ret), temp_ip, link_hash);
-
-    // Check link cache
-    if (link_cache[link_hash] && link_cache[link_hash]->cache.start == temp_ip) {
-        block = link_cache[link_hash];
-        printf("[CORE_DYNREC] LinkBlocks: Found cached block at 0x%lx, linking to it\n", 
-               temp_ip);
-        cache.block.running->LinkTo(ret == BlockReturn::Link2, block);
-        printf("[CORE_DYNREC] LinkBlocks: Exiting, returning block=%p\n", block);
-        return block;
-    }
-
+    const PhysPt temp_ip = SegPhys(cs) + reg_eip;
     auto* temp_handler = static_cast<CodePageHandlerDynRec*>(get_tlb_readhandler(temp_ip));
-    if (temp_handler->flags & PFLAG_HASCODE) {
-        block = temp_handler->FindCacheBlock(temp_ip & 4095);
-        if (block) {
-            printf("[CORE_DYNREC] LinkBlocks: Found block at 0x%lx in handler, linking\n", 
-                   temp_ip);
-            cache.block.running->LinkTo(ret == BlockReturn::Link2, block);
-            link_cache[link_hash] = block;
-            __builtin_prefetch(block->cache.start);
-        } else {
-            printf("[CORE_DYNREC] LinkBlocks: No block found at 0x%lx in handler\n", 
-                   temp_ip);
-        }
-    } else {
-        printf("[CORE_DYNREC] LinkBlocks: Handler at 0x%lx has no code\n", temp_ip);
-    }
-    printf("[CORE_DYNREC] LinkBlocks: Exiting, returning block=%p\n", block);
+    if (!(temp_handler->flags & PFLAG_HASCODE)) return nullptr;
+
+    CacheBlockDynRec* block = temp_handler->FindCacheBlock(temp_ip & 4095);
+    if (!block) return nullptr;
+    // cache.block.running is set by the code of every block when it starts
+    cache.block.running->LinkTo(ret == BlockReturn::Link2, block);
     return block;
 }
 
+/*
+    Find the block for CS:EIP, translating the instruction stream there if
+    there is none yet (see decoder.h), and run it. The return code of the
+    block, which may come from a block linked to it much later, decides
+    whether to go on with the next block or to leave the core.
+*/
 Bits CPU_Core_Dynrec_Run() {
-    printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: Entering\n");
-    // TLB with timing checks
-    static PhysPt last_ip_page = 0;
-    static CodePageHandlerDynRec* last_handler = nullptr;
-    static Bitu pit_check_counter = 0;
-
-    printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: Starting, cs=0x%lx, eip=0x%lx\n", 
-           SegValue(cs), reg_eip);
-
     for (;;) {
         const PhysPt ip_point = SegPhys(cs) + reg_eip;
-        printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: ip_point=0x%lx\n", ip_point);
-
 #if C_HEAVY_DEBUG
-        if (DEBUG_HeavyIsBreakpoint()) {
-            printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: Breakpoint hit, returning debugCallback\n");
-            return debugCallback;
-        }
+        if (DEBUG_HeavyIsBreakpoint()) return debugCallback;
 #endif
 
         CodePageHandlerDynRec* chandler = nullptr;
-        if ((ip_point & ~(PAGESIZE - 1)) == last_ip_page && last_handler) {
-            chandler = last_handler;
-            printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: Using cached handler for page 0x%lx\n", 
-                   last_ip_page);
-        } else {
-            printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: Looking up handler for ip_point=0x%lx\n", 
-                   ip_point);
-            if (GCC_UNLIKELY(MakeCodePage(ip_point, chandler))) {
-                printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: MakeCodePage failed, raising exception %ld\n", 
-                       cpu.exception.which);
-                CPU_Exception(cpu.exception.which, cpu.exception.error);
-                continue;
-            }
-            last_ip_page = ip_point & ~(PAGESIZE - 1);
-            last_handler = chandler;
-            printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: Updated last_ip_page=0x%lx, handler=%p\n", 
-                   last_ip_page, chandler);
+        if (GCC_UNLIKELY(MakeCodePage(ip_point, chandler))) {
+            // page not present, throw the exception
+            CPU_Exception(cpu.exception.which, cpu.exception.error);
+            continue;
         }
 
-        if (GCC_UNLIKELY(!chandler)) {
-            printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: No handler, falling back to normal core\n");
-            return CPU_Core_Normal_Run();
-        }
+        // page doesn't contain code or is special
+        if (GCC_UNLIKELY(!chandler)) return CPU_Core_Normal_Run();
 
         CacheBlockDynRec* block = chandler->FindCacheBlock(ip_point & 4095);
         if (!block) {
-            printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: No block at 0x%lx, creating new\n", 
-                   ip_point);
-            if (!chandler->invalidation_map || chandler->invalidation_map[ip_point & 4095] < 2) {
-                block = CreateCacheBlock(chandler, ip_point, 48); // Balanced block size
-                printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: Created block at 0x%lx\n", ip_point);
+            // translate up to 32 instructions unless the code here is
+            // known to be modified a lot
+            if (!chandler->invalidation_map || chandler->invalidation_map[ip_point & 4095] < 4) {
+                // a translation saved by an earlier run is used as it is
+                block = cache_file_findblock(chandler, ip_point);
+                if (!block) {
+                    block = CreateCacheBlock(chandler, ip_point, 32);
+                    cache_file_addblock(block, ip_point);
+                }
             } else {
-                const Bitu old_cycles = CPU_Cycles;
+                // let the normal core run this instruction to avoid
+                // translating a block that is thrown away right after
+                const Bits old_cycles = CPU_Cycles;
                 CPU_Cycles = 1;
-                printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: Invalidation map hit, running normal core\n");
                 const Bits nc_retcode = CPU_Core_Normal_Run();
                 if (!nc_retcode) {
                     CPU_Cycles = old_cycles - 1;
-                    printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: Normal core returned 0, continuing\n");
+                    // no block runs in this path, so check the cycles here
+                    if (CPU_Cycles <= 0) return CBRET_NONE;
                     continue;
                 }
                 CPU_CycleLeft += old_cycles;
-                printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: Normal core returned %ld\n", nc_retcode);
                 return nc_retcode;
             }
         }
 
 run_block:
-        cache.block.running = block;
-        printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: Running block at 0x%lx, start=%p\n", 
-               ip_point, block->cache.start);
+        cache.block.running = nullptr;
         const BlockReturn ret = core_dynrec.runcode(block->cache.start);
-        printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: Block returned %d\n", static_cast<int>(ret));
-
-        // Periodic PIT check to ensure timing-critical devices (e.g., PCSpeaker)
-        if (++pit_check_counter >= 16) {
-            if (PIC_IRQCheck & 0x1) {
-                printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: PIT IRQ pending, returning CBRET_NONE\n");
-                return CBRET_NONE; // Force PIT IRQ
-            }
-            pit_check_counter = 0;
-            printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: PIT check, no IRQ\n");
-        }
 
         switch (ret) {
         case BlockReturn::Iret:
-#if C_DEBUG
 #if C_HEAVY_DEBUG
-            if (DEBUG_HeavyIsBreakpoint()) {
-                printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: IRET with breakpoint, returning debugCallback\n");
-                return debugCallback;
-            }
-#endif
+            if (DEBUG_HeavyIsBreakpoint()) return debugCallback;
 #endif
             if (!GETFLAG(TF)) {
-                if (GETFLAG(IF) && PIC_IRQCheck) {
-                    printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: IRET with IRQ pending, returning CBRET_NONE\n");
-                    return CBRET_NONE;
-                }
-                printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: IRET, continuing\n");
+                if (GETFLAG(IF) && PIC_IRQCheck) return CBRET_NONE;
                 break;
             }
+            // trap flag is set, switch to the trap-aware decoder
             cpudecoder = CPU_Core_Dynrec_Trap_Run;
-            printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: IRET with TF, switching to trap run\n");
             return CBRET_NONE;
 
         case BlockReturn::Normal:
-#if C_DEBUG
+            // left through an unpredictable control transfer, a cpu state
+            // change or because the block ended
 #if C_HEAVY_DEBUG
-            if (DEBUG_HeavyIsBreakpoint()) {
-                printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: Normal with breakpoint, returning debugCallback\n");
-                return debugCallback;
-            }
-#endif
+            if (DEBUG_HeavyIsBreakpoint()) return debugCallback;
 #endif
-            printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: Normal return, continuing\n");
             break;
 
         case BlockReturn::Cycles:
-#if C_DEBUG
+            // cycles ran out, leave the core to handle the pic and events
 #if C_HEAVY_DEBUG
-            if (DEBUG_HeavyIsBreakpoint()) {
-                printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: Cycles with breakpoint, returning debugCallback\n");
-                return debugCallback;
-            }
+            if (DEBUG_HeavyIsBreakpoint()) return debugCallback;
 #endif
-#endif
-            printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: Cycles exhausted, returning CBRET_NONE\n");
             return CBRET_NONE;
 
         case BlockReturn::CallBack:
             FillFlags();
-            printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: Callback, returning 0x%lx\n", 
-                   core_dynrec.callback);
             return core_dynrec.callback;
 
         case BlockReturn::SMCBlock:
+            // the block modified itself, let the normal core run the
+            // modifying instruction
             cpu.exception.which = 0;
-            printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: SMCBlock, clearing exception\n");
             [[fallthrough]];
         case BlockReturn::Opcode:
+            // an instruction that was not translated, it is not part of
+            // the block and the normal core runs it
             CPU_CycleLeft += CPU_Cycles;
             CPU_Cycles = 1;
-            printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: Opcode/SMC, running normal core\n");
             return CPU_Core_Normal_Run();
 
 #if C_DEBUG
         case BlockReturn::OpcodeFull:
             CPU_CycleLeft += CPU_Cycles;
             CPU_Cycles = 1;
-            printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: OpcodeFull, running full core\n");
             return CPU_Core_Full_Run();
 #endif
 
         case BlockReturn::Link1:
         case BlockReturn::Link2:
-            printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: Linking block, ret=%d\n", 
-                   static_cast<int>(ret));
             block = LinkBlocks(ret);
-            if (block) {
-                printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: Linked to block at 0x%lx\n", 
-                       SegPhys(cs) + reg_eip);
-                goto run_block;
-            }
-            printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: No block to link, continuing\n");
+            if (block) goto run_block;
             break;
 
         default:
-            printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: Invalid return code %d\n", 
-                   static_cast<int>(ret));
             E_Exit("Invalid return code %d", static_cast<int>(ret));
         }
     }
-    printf("[CORE_DYNREC] CPU_Core_Dynrec_Run: Exiting with CBRET_NONE\n");
     return CBRET_NONE;
 }
 
 Bits CPU_Core_Dynrec_Trap_Run() {
-    printf("[CORE_DYNREC] CPU_Core_Dynrec_Trap_Run: Entering\n");
     const Bits oldCycles = CPU_Cycles;
     CPU_Cycles = 1;
     cpu.trap_skip = false;
 
-    printf("[CORE_DYNREC] CPU_Core_Dynrec_Trap_Run: Running normal core, oldCycles=%ld\n", oldCycles);
+    // let the normal core run exactly one instruction
     const Bits ret = CPU_Core_Normal_Run();
-    if (!cpu.trap_skip) {
-        printf("[CORE_DYNREC] CPU_Core_Dynrec_Trap_Run: Triggering HW interrupt 1\n");
-        CPU_HW_Interrupt(1);
-    }
+    if (!cpu.trap_skip) CPU_HW_Interrupt(1);
 
     CPU_Cycles = oldCycles - 1;
     cpudecoder = &CPU_Core_Dynrec_Run;
-    printf("[CORE_DYNREC] CPU_Core_Dynrec_Trap_Run: Exiting, returning %ld\n", ret);
     return ret;
 }
 
 void CPU_Core_Dynrec_Init() {
-    printf("[CORE_DYNREC] CPU_Core_Dynrec_Init: Initializing link cache\n");
-    link_cache.fill(nullptr);
-    printf("[CORE_DYNREC] CPU_Core_Dynrec_Init: Exiting\n");
 }
 
 void CPU_Core_Dynrec_Cache_Init(bool enable_cache) {
-    printf("[CORE_DYNREC] CPU_Core_Dynrec_Cache_Init: Initializing cache, enable_cache=%d\n", enable_cache);
     cache_init(enable_cache);
-    printf("[CORE_DYNREC] CPU_Core_Dynrec_Cache_Init: Exiting\n");
+}
+
+void CPU_Core_Dynrec_Cache_File(const char* name) {
+    cache_file_open(name);
 }
 
 void CPU_Core_Dynrec_Cache_Close() {
-    printf("[CORE_DYNREC] CPU_Core_Dynrec_Cache_Close: Closing cache\n");
+    cache_file_close();
     cache_close();
-    printf("[CORE_DYNREC] CPU_Core_Dynrec_Cache_Close: Exiting\n");
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -116,43 +116,32 @@ public:
 	}
 
 	// clear out blocks that contain code which has been modified
-	bool InvalidateRange(Bitu start, Bitu end) {
-    Bits index = (end >> DYN_HASH_SHIFT);
-    bool is_current_block = false;
+	bool InvalidateRange(Bitu start,Bitu end) {
+		Bits index=1+(end>>DYN_HASH_SHIFT);
+		bool is_current_block=false;	// if the current block is modified, it has to be exited as soon as possible
+
+		Bit32u ip_point=SegPhys(cs)+reg_eip;
+		ip_point=(PAGING_GetPhysicalPage(ip_point)-(phys_page<<12))+(ip_point&0xfff);
+		while (index>=0) {
+			Bitu map=0;
+			// see if there is still some code in the range
+			for (Bitu count=start;count<=end;count++) map+=write_map[count];
+			if (!map) return is_current_block;	// no more code, finished
 
-    Bit32u ip_point = SegPhys(cs) + reg_eip;
-    ip_point = (PAGING_GetPhysicalPage(ip_point) - (phys_page << 12)) + (ip_point & 0xfff);
-
-    while (index >= 0) {
-        Bitu map = 0;
-        for (Bitu i = start; i <= end; i++) {
-            map |= write_map[i];
-        }
-        if (!map) return is_current_block;
-
-        CacheBlockDynRec * block = hash_map[index];
-        CacheBlockDynRec * prev = NULL;
-        while (block) {
-            CacheBlockDynRec * nextblock = block->hash.next;
-            if (start <= block->page.end && end >= block->page.start) {
-                if (ip_point <= block->page.end && ip_point >= block->page.start) {
-                    is_current_block = true;
-                }
-                block->Clear();
-                if (prev) {
-                    prev->hash.next = nextblock;
-                } else {
-                    hash_map[index] = nextblock;
-                }
-            } else {
-                prev = block;
-            }
-            block = nextblock;
-        }
-        index--;
-    }
-    return is_current_block;
-}
+			CacheBlockDynRec * block=hash_map[index];
+			while (block) {
+				CacheBlockDynRec * nextblock=block->hash.next;
+				// test if this block is in the range
+				if (start<=block->page.end && end>=block->page.start) {
+					if (ip_point<=block->page.end && ip_point>=block->page.start) is_current_block=true;
+					block->Clear();		// clear the block, unlinks it from the hash map and decrements the write_map
+				}
+				block=nextblock;
+			}
+			index--;
+		}
+		return is_current_block;
+	}
 
 	// the following functions will clean all cache blocks that are invalid now due to the write
 	void writeb(PhysPt addr, Bitu val) {
@@ -478,8 +467,75 @@ void CacheBlockDynRec::Clear(void) {
 }
 
 
+// host addresses in the code of the block that is being generated, noted by
+// backends that define DRC_USE_RELOCATIONS so the block can be saved and
+// placed somewhere else later on (see cache_file.h)
+#define CACHE_RELOCS 256
+
+enum {
+	RELOC_HOST=0,		// function or global of the emulator, relative to cpu_regs
+	RELOC_BLOCK			// field of the CacheBlockDynRec, relative to the block
+};
+
+struct CacheReloc {
+	Bit64s target;		// address relative to cpu_regs or to the block
+	Bit16u pos;			// offset of the address in the generated code
+	Bit8u type;			// how the address is encoded, see gen_fill_reloc
+	Bit8u kind;			// RELOC_HOST or RELOC_BLOCK
+	Bit32u unused;
+};
+
+static struct {
+	CacheReloc list[CACHE_RELOCS];
+	Bitu count;
+	bool fixed;			// the code has an address that can't be moved
+} cache_relocs;
+
+// note an address at pos in the generated code, regs_relative is set if it
+// is encoded relative to cpu_regs and only has to change for block fields
+static void cache_addreloc(Bit8u * pos,Bitu type,void * target,bool regs_relative=false) {
+	CacheBlockDynRec * block=cache.block.active;
+	Bit8u * addr=(Bit8u *)target;
+	CacheReloc reloc;
+	if (addr>=(Bit8u *)block && addr<(Bit8u *)(block+1)) {
+		reloc.kind=RELOC_BLOCK;
+		reloc.target=addr-(Bit8u *)block;
+	} else {
+		// guest memory and other cache blocks are different in every run
+		if ((MemBase && addr>=MemBase && addr<MemBase+MEM_TotalPages()*4096) ||
+			(addr>=(Bit8u *)cache_blocks && addr<(Bit8u *)(cache_blocks+CACHE_BLOCKS))) {
+			cache_relocs.fixed=true;
+			return;
+		}
+		if (regs_relative) return;
+		reloc.kind=RELOC_HOST;
+		reloc.target=addr-(Bit8u *)&cpu_regs;
+	}
+	if (cache_relocs.count>=CACHE_RELOCS) {
+		cache_relocs.fixed=true;
+		return;
+	}
+	reloc.pos=(Bit16u)(pos-block->cache.start);
+	reloc.type=(Bit8u)type;
+	reloc.unused=0;
+	cache_relocs.list[cache_relocs.count++]=reloc;
+}
+
+// the address at pos has been overwritten by code
+static void cache_delreloc(Bit8u * pos) {
+	Bit16u offset=(Bit16u)(pos-cache.block.active->cache.start);
+	for (Bitu i=0;i<cache_relocs.count;i++) {
+		if (cache_relocs.list[i].pos!=offset) continue;
+		cache_relocs.list[i]=cache_relocs.list[--cache_relocs.count];
+		return;
+	}
+}
+
+
 static CacheBlockDynRec * cache_openblock(void) {
 	CacheBlockDynRec * block=cache.block.active;
+	cache_relocs.count=0;
+	cache_relocs.fixed=false;
 	// check for enough space in this block
 	Bitu size=block->cache.size;
 	CacheBlockDynRec * nextblock=block->cache.next;
@@ -614,7 +670,8 @@ static void cache_init(bool enable) {
 #elif defined (HAVE_MMAP)
 			cache_code_start_ptr=(Bit8u*)mmap(
 				0, CACHE_CODE_SIZE,
-				PROT_READ|PROT_WRITE|PROT_EXEC, MAP_ANON, -1, 0);
+				PROT_READ|PROT_WRITE|PROT_EXEC, MAP_PRIVATE|MAP_ANON, -1, 0);
+			if (cache_code_start_ptr==MAP_FAILED) cache_code_start_ptr=NULL;
 #else
 			cache_code_start_ptr=(Bit8u*)malloc(CACHE_CODE_SIZE);
 #endif
@@ -641,11 +698,11 @@ static void cache_init(bool enable) {
 		cache.pos=&cache_code_link_blocks[0];
 		link_blocks[0].cache.start=cache.pos;
 		// link code that returns with a special return code
-		dyn_return(BR_Link1,false);
+		dyn_return(BlockReturn::Link1,false);
 		cache.pos=&cache_code_link_blocks[32];
 		link_blocks[1].cache.start=cache.pos;
 		// link code that returns with a special return code
-		dyn_return(BR_Link2,false);
+		dyn_return(BlockReturn::Link2,false);
 
 		cache.pos=&cache_code_link_blocks[64];
 		core_dynrec.runcode=(BlockReturn (*)(Bit8u*))cache.pos;
@@ -0,0 +1,286 @@
+/*
+ *  Copyright (C) 2002-2025  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+
+// Translations that are kept in a file between runs ([cpu] dynamic_cache).
+// A block is saved together with the guest code it was translated from and
+// the host addresses in its code (see cache_addreloc). When the same code is
+// run at the same physical address in the same cpu mode later on, the saved
+// code is placed into the cache instead of translating the instructions again.
+
+#if defined(DRC_USE_RELOCATIONS) && defined(__ELF__)
+
+#include <link.h>
+#include <unordered_map>
+#include <vector>
+
+#define CACHE_FILE_VERSION 1
+// no more blocks are saved once the file has this size
+#define CACHE_FILE_MAX (64*1024*1024)
+
+struct CacheFileHeader {
+	char magic[8];
+	Bit32u version;
+	Bit32u block_size;		// sizeof(CacheBlockDynRec)
+	Bit64u build;			// hash of the emulator code, see cache_file_build
+};
+
+// followed by the guest code, the generated code and the CacheReloc entries
+struct CacheFileRecord {
+	Bit32u phys;			// physical address of the first guest code byte
+	Bit16u code_size;
+	Bit16u host_size;
+	Bit16u reloc_count;
+	Bit8u mode;				// see cache_file_mode
+	Bit8u unused;
+	Bit32u check;			// hash of the record and its data
+};
+
+struct CacheFileBlock {
+	std::vector<Bit8u> code;
+	std::vector<Bit8u> host;
+	std::vector<CacheReloc> relocs;
+};
+
+static struct {
+	FILE * file;			// new blocks are appended
+	Bitu size;
+	CacheFileHeader header;
+	// saved blocks by physical address and mode, several blocks can have
+	// the same key when different programs are loaded there
+	std::unordered_multimap<Bit64u,CacheFileBlock> blocks;
+	Bitu reused;
+} cache_file;
+
+// the cpu state that the decoder looks at besides the code
+static Bit8u cache_file_mode(void) {
+	return (cpu.code.big ? 1 : 0) | (cpu.pmode ? 2 : 0) |
+		((reg_flags & FLAG_VM) ? 4 : 0) | (cpu.cpl ? 8 : 0);
+}
+
+static Bit32u cache_file_hash(Bit32u hash,const void * data,Bitu size) {
+	const Bit8u * bytes=(const Bit8u *)data;
+	for (Bitu ct=0;ct<size;ct++) hash=(hash^bytes[ct])*16777619;
+	return hash;
+}
+
+static Bit32u cache_file_check(CacheFileRecord record,const CacheFileBlock & block) {
+	record.check=0;
+	Bit32u hash=cache_file_hash(2166136261u,&record,sizeof(record));
+	hash=cache_file_hash(hash,block.code.data(),block.code.size());
+	hash=cache_file_hash(hash,block.host.data(),block.host.size());
+	return cache_file_hash(hash,block.relocs.data(),block.relocs.size()*sizeof(CacheReloc));
+}
+
+// the generated code contains the offsets of the emulator's functions and
+// globals, so saved blocks can only be used by the same build; it is told
+// apart by a hash of the code segment that contains the core
+static int cache_file_build(struct dl_phdr_info * info,size_t /*size*/,void * data) {
+	Bitu anchor=(Bitu)(void *)&cache_file_build;
+	for (int ct=0;ct<info->dlpi_phnum;ct++) {
+		const ElfW(Phdr) * phdr=&info->dlpi_phdr[ct];
+		if (phdr->p_type!=PT_LOAD || !(phdr->p_flags & PF_X)) continue;
+		Bitu start=(Bitu)(info->dlpi_addr+phdr->p_vaddr);
+		if (anchor<start || anchor>=start+phdr->p_memsz) continue;
+		const Bit8u * code=(const Bit8u *)start;
+		Bit64u hash=14695981039346656037ULL;
+		for (Bitu pos=0;pos<phdr->p_filesz;pos++) hash=(hash^code[pos])*1099511628211ULL;
+		*(Bit64u *)data=hash;
+		return 1;
+	}
+	return 0;
+}
+
+static void cache_file_write(Bit64u key,const CacheFileBlock & block) {
+	CacheFileRecord record;
+	memset(&record,0,sizeof(record));
+	record.phys=(Bit32u)(key >> 8);
+	record.mode=(Bit8u)key;
+	record.code_size=(Bit16u)block.code.size();
+	record.host_size=(Bit16u)block.host.size();
+	record.reloc_count=(Bit16u)block.relocs.size();
+	record.check=cache_file_check(record,block);
+	fwrite(&record,sizeof(record),1,cache_file.file);
+	fwrite(block.code.data(),1,block.code.size(),cache_file.file);
+	fwrite(block.host.data(),1,block.host.size(),cache_file.file);
+	fwrite(block.relocs.data(),sizeof(CacheReloc),block.relocs.size(),cache_file.file);
+	cache_file.size+=sizeof(record)+block.code.size()+block.host.size()+block.relocs.size()*sizeof(CacheReloc);
+}
+
+static bool cache_file_read(FILE * file,Bit64u & key,CacheFileBlock & block) {
+	CacheFileRecord record;
+	if (fread(&record,sizeof(record),1,file)!=1) return false;
+	if (!record.code_size || record.code_size>4096 || record.host_size>CACHE_MAXSIZE ||
+		record.reloc_count>CACHE_RELOCS) return false;
+	block.code.resize(record.code_size);
+	block.host.resize(record.host_size);
+	block.relocs.resize(record.reloc_count);
+	if (fread(block.code.data(),1,block.code.size(),file)!=block.code.size()) return false;
+	if (fread(block.host.data(),1,block.host.size(),file)!=block.host.size()) return false;
+	if (fread(block.relocs.data(),sizeof(CacheReloc),block.relocs.size(),file)!=block.relocs.size()) return false;
+	if (record.check!=cache_file_check(record,block)) return false;
+	for (const CacheReloc & reloc : block.relocs) {
+		if (reloc.pos>=block.host.size() || reloc.kind>RELOC_BLOCK) return false;
+	}
+	key=((Bit64u)record.phys << 8) | record.mode;
+	return true;
+}
+
+static void cache_file_open(const char * name) {
+	if (cache_file.file || !name || !*name) return;
+	memset(&cache_file.header,0,sizeof(cache_file.header));
+	memcpy(cache_file.header.magic,"DRCBLOCK",8);
+	cache_file.header.version=CACHE_FILE_VERSION;
+	cache_file.header.block_size=sizeof(CacheBlockDynRec);
+	if (!dl_iterate_phdr(&cache_file_build,&cache_file.header.build)) {
+		LOG_MSG("DYNREC:Can't identify the emulator code, translations are not saved");
+		return;
+	}
+
+	// read the blocks of earlier runs of this build, the file is
+	// written anew if it ends with a damaged block
+	bool complete=false;
+	FILE * file=fopen(name,"rb");
+	if (file) {
+		CacheFileHeader header;
+		if (fread(&header,sizeof(header),1,file)==1 && !memcmp(&header,&cache_file.header,sizeof(header))) {
+			for (;;) {
+				long good=ftell(file);
+				Bit64u key;
+				CacheFileBlock block;
+				if (!cache_file_read(file,key,block)) {
+					fseek(file,0,SEEK_END);
+					complete=(ftell(file)==good);
+					break;
+				}
+				cache_file.blocks.emplace(key,std::move(block));
+			}
+		}
+		fclose(file);
+	}
+
+	if (complete) {
+		cache_file.file=fopen(name,"ab");
+		if (cache_file.file) {
+			fseek(cache_file.file,0,SEEK_END);
+			cache_file.size=(Bitu)ftell(cache_file.file);
+		}
+	} else {
+		cache_file.file=fopen(name,"wb");
+		if (cache_file.file) {
+			fwrite(&cache_file.header,sizeof(cache_file.header),1,cache_file.file);
+			cache_file.size=sizeof(cache_file.header);
+			for (const auto & entry : cache_file.blocks) cache_file_write(entry.first,entry.second);
+			fflush(cache_file.file);
+		}
+	}
+	if (!cache_file.file) {
+		LOG_MSG("DYNREC:Can't open %s, translations are not saved",name);
+		cache_file.blocks.clear();
+		return;
+	}
+	LOG_MSG("DYNREC:%d saved translations in %s",(int)cache_file.blocks.size(),name);
+}
+
+static void cache_file_close(void) {
+	if (!cache_file.file) return;
+	fclose(cache_file.file);
+	cache_file.file=NULL;
+	LOG_MSG("DYNREC:%d translations were taken from the saved ones",(int)cache_file.reused);
+	cache_file.blocks.clear();
+}
+
+// place a saved translation of the code at start into the cache if
+// there is one; only pages without modified code are looked at, like
+// the saved blocks the decoder did not read anything but the code there
+static CacheBlockDynRec * cache_file_findblock(CodePageHandlerDynRec * codepage,PhysPt start) {
+	if (!cache_file.file || codepage->invalidation_map) return 0;
+	Bitu offset=start&4095;
+	Bit64u key=((Bit64u)(PAGING_GetPhysicalPage(start)|offset) << 8) | cache_file_mode();
+	auto range=cache_file.blocks.equal_range(key);
+	for (auto it=range.first;it!=range.second;++it) {
+		const CacheFileBlock & saved=it->second;
+		if (offset+saved.code.size()>4096) continue;
+		Bitu ct=0;
+		while (ct<saved.code.size() && mem_readb(start+ct)==saved.code[ct]) ct++;
+		if (ct<saved.code.size()) continue;
+
+		CacheBlockDynRec * block=cache_openblock();
+		memcpy(cache.pos,saved.host.data(),saved.host.size());
+		for (const CacheReloc & reloc : saved.relocs) {
+			Bit8u * base=(reloc.kind==RELOC_BLOCK) ? (Bit8u *)block : (Bit8u *)&cpu_regs;
+			// the open block is used by CreateCacheBlock then
+			if (!gen_fill_reloc(cache.pos+reloc.pos,reloc.type,base+reloc.target)) return 0;
+		}
+		cache.pos+=saved.host.size();
+
+		block->page.start=(Bit16u)offset;
+		block->page.end=(Bit16u)(offset+saved.code.size()-1);
+		codepage->AddCacheBlock(block);
+		// the decoder counts every byte it fetched in the write map
+		for (Bitu pos=block->page.start;pos<=block->page.end;pos++) codepage->write_map[pos]++;
+		cache_closeblock();
+		cache_block_closing(block->cache.start,block->cache.size);
+		cache_file.reused++;
+		return block;
+	}
+	return 0;
+}
+
+// save the block that was just translated from the code at start
+static void cache_file_addblock(CacheBlockDynRec * block,PhysPt start) {
+	if (!cache_file.file || cache_relocs.fixed || cache_file.size>=CACHE_FILE_MAX) return;
+	// the code has to be in one page that was not modified, immediates that
+	// are read from guest memory at runtime set up a writemap mask
+	if (block->crossblock || block->cache.wmapmask || block->page.handler->invalidation_map) return;
+	Bitu host_size=(Bitu)(cache.pos-block->cache.start);
+	if (host_size>CACHE_MAXSIZE) return;
+
+	CacheFileBlock saved;
+	saved.code.resize(block->page.end-block->page.start+1);
+	for (Bitu ct=0;ct<saved.code.size();ct++) saved.code[ct]=mem_readb(start+ct);
+	Bit64u key=((Bit64u)(PAGING_GetPhysicalPage(start)|(start&4095)) << 8) | cache_file_mode();
+	auto range=cache_file.blocks.equal_range(key);
+	for (auto it=range.first;it!=range.second;++it) {
+		// saved already, but could not be placed (see gen_fill_reloc)
+		if (it->second.code==saved.code) return;
+	}
+	saved.host.assign(block->cache.start,block->cache.start+host_size);
+	saved.relocs.assign(cache_relocs.list,cache_relocs.list+cache_relocs.count);
+
+	cache_file_write(key,saved);
+	fflush(cache_file.file);
+	cache_file.blocks.emplace(key,std::move(saved));
+}
+
+#else
+
+static void cache_file_open(const char * name) {
+	if (name && *name) LOG_MSG("DYNREC:Translations can't be saved on this platform");
+}
+
+static void cache_file_close(void) { }
+
+static CacheBlockDynRec * cache_file_findblock(CodePageHandlerDynRec * /*codepage*/,PhysPt /*start*/) {
+	return 0;
+}
+
+static void cache_file_addblock(CacheBlockDynRec * /*block*/,PhysPt /*start*/) { }
+
+#endif
@@ -503,6 +503,14 @@ static INLINE void dyn_set_eip_end(HostReg reg,Bit32u imm=0) {
 // is architecture dependent
 // R=host register; I=32bit immediate value; A=address value; m=memory
 
+#ifndef DRC_USE_REGS_CACHE
+// call to a helper that does not access the guest registers, only backends
+// that keep guest registers in host registers have to tell them apart
+static void INLINE gen_call_function_pure(void * func) {
+	gen_call_function_raw(func);
+}
+#endif
+
 static DRC_PTR_SIZE_IM INLINE gen_call_function_R(void * func,Bitu op) {
 	gen_load_param_reg(op,0);
 	return gen_call_function_setup(func, 1);
@@ -604,9 +612,9 @@ enum save_info_type {db_exception, cycle_check, string_break};
 static BlockReturn DynRunException(Bit32u eip_add,Bit32u cycle_sub) {
 	reg_eip+=eip_add;
 	CPU_Cycles-=cycle_sub;
-	if (cpu.exception.which==SMC_CURRENT_BLOCK) return BR_SMCBlock;
+	if (cpu.exception.which==SMC_CURRENT_BLOCK) return BlockReturn::SMCBlock;
 	CPU_Exception(cpu.exception.which,cpu.exception.error);
-	return BR_Normal;
+	return BlockReturn::Normal;
 }
 
 
@@ -625,7 +633,7 @@ Bitu used_save_info_dynrec=0;
 // return from current block, with returncode
 static void dyn_return(BlockReturn retcode,bool ret_exception=false) {
 	if (!ret_exception) {
-		gen_mov_dword_to_reg_imm(FC_RETOP,retcode);
+		gen_mov_dword_to_reg_imm(FC_RETOP,static_cast<Bit32u>(retcode));
 	}
 	gen_return_function();
 }
@@ -646,16 +654,16 @@ static void dyn_fill_blocks(void) {
 				decode.cycles=save_info_dynrec[sct].cycles;
 				if (cpu.code.big) gen_call_function_II((void *)&DynRunException,save_info_dynrec[sct].eip_change,save_info_dynrec[sct].cycles);
 				else gen_call_function_II((void *)&DynRunException,save_info_dynrec[sct].eip_change&0xffff,save_info_dynrec[sct].cycles);
-				dyn_return(BR_Normal,true);
+				dyn_return(BlockReturn::Normal,true);
 				break;
 			case cycle_check:
 				// cycles are <=0 so exit the core
-				dyn_return(BR_Cycles);
+				dyn_return(BlockReturn::Cycles);
 				break;
 			case string_break:
 				// interrupt looped string instruction, can be continued later
 				gen_add_direct_word(&reg_eip,save_info_dynrec[sct].eip_change,decode.big_op);
-				dyn_return(BR_Cycles);
+				dyn_return(BlockReturn::Cycles);
 				break;
 		}
 	}
@@ -756,13 +764,13 @@ bool DRC_CALL_CONV mem_writed_checked_drc(PhysPt address,Bit32u val) {
 // read a byte from a given address and store it in reg_dst
 static void dyn_read_byte(HostReg reg_addr,HostReg reg_dst) {
 	gen_mov_regs(FC_OP1,reg_addr);
-	gen_call_function_raw((void *)&mem_readb_checked_drc);
+	gen_call_function_pure((void *)&mem_readb_checked_drc);
 	dyn_check_exception(FC_RETOP);
 	gen_mov_byte_to_reg_low(reg_dst,&core_dynrec.readdata);
 }
 static void dyn_read_byte_canuseword(HostReg reg_addr,HostReg reg_dst) {
 	gen_mov_regs(FC_OP1,reg_addr);
-	gen_call_function_raw((void *)&mem_readb_checked_drc);
+	gen_call_function_pure((void *)&mem_readb_checked_drc);
 	dyn_check_exception(FC_RETOP);
 	gen_mov_byte_to_reg_low_canuseword(reg_dst,&core_dynrec.readdata);
 }
@@ -771,7 +779,7 @@ static void dyn_read_byte_canuseword(HostReg reg_addr,HostReg reg_dst) {
 static void dyn_write_byte(HostReg reg_addr,HostReg reg_val) {
 	gen_mov_regs(FC_OP2,reg_val);
 	gen_mov_regs(FC_OP1,reg_addr);
-	gen_call_function_raw((void *)&mem_writeb_checked_drc);
+	gen_call_function_pure((void *)&mem_writeb_checked_drc);
 	dyn_check_exception(FC_RETOP);
 }
 
@@ -779,8 +787,8 @@ static void dyn_write_byte(HostReg reg_addr,HostReg reg_val) {
 // from a given address and store it in reg_dst
 static void dyn_read_word(HostReg reg_addr,HostReg reg_dst,bool dword) {
 	gen_mov_regs(FC_OP1,reg_addr);
-	if (dword) gen_call_function_raw((void *)&mem_readd_checked_drc);
-	else gen_call_function_raw((void *)&mem_readw_checked_drc);
+	if (dword) gen_call_function_pure((void *)&mem_readd_checked_drc);
+	else gen_call_function_pure((void *)&mem_readw_checked_drc);
 	dyn_check_exception(FC_RETOP);
 	gen_mov_word_to_reg(reg_dst,&core_dynrec.readdata,dword);
 }
@@ -791,8 +799,8 @@ static void dyn_write_word(HostReg reg_addr,HostReg reg_val,bool dword) {
 //	if (!dword) gen_extend_word(false,reg_val);
 	gen_mov_regs(FC_OP2,reg_val);
 	gen_mov_regs(FC_OP1,reg_addr);
-	if (dword) gen_call_function_raw((void *)&mem_writed_checked_drc);
-	else gen_call_function_raw((void *)&mem_writew_checked_drc);
+	if (dword) gen_call_function_pure((void *)&mem_writed_checked_drc);
+	else gen_call_function_pure((void *)&mem_writew_checked_drc);
 	dyn_check_exception(FC_RETOP);
 }
 
@@ -1197,12 +1205,16 @@ static void gen_restore_reg(HostReg reg,HostReg dest_reg) {
 // they try to find out if a function can be replaced by another
 // one that does not generate any flags at all
 
+// instructions whose flags are still waiting for a later instruction
+// that overwrites them; one entry per instruction at most
+#define MF_FUNCTIONS_MAX 64
+
 static Bitu mf_functions_num=0;
 static struct {
 	Bit8u* pos;
 	void* fct_ptr;
 	Bitu ftype;
-} mf_functions[64];
+} mf_functions[MF_FUNCTIONS_MAX];
 
 static void InitFlagsOptimization(void) {
 	mf_functions_num=0;
@@ -1240,6 +1252,8 @@ static void InvalidateFlags(void* current_simple_function,Bitu flags_type) {
 // this function can be replaced by a simpler one as well
 static void InvalidateFlagsPartially(void* current_simple_function,Bitu flags_type) {
 #ifdef DRC_FLAGS_INVALIDATION
+	// leaving an instruction with its full flags function is always safe
+	if (mf_functions_num>=MF_FUNCTIONS_MAX) return;
 	mf_functions[mf_functions_num].pos=cache.pos;
 	mf_functions[mf_functions_num].fct_ptr=current_simple_function;
 	mf_functions[mf_functions_num].ftype=flags_type;
@@ -1252,6 +1266,7 @@ static void InvalidateFlagsPartially(void* current_simple_function,Bitu flags_ty
 // this function can be replaced by a simpler one as well
 static void InvalidateFlagsPartially(void* current_simple_function,DRC_PTR_SIZE_IM cpos,Bitu flags_type) {
 #ifdef DRC_FLAGS_INVALIDATION
+	if (mf_functions_num>=MF_FUNCTIONS_MAX) return;
 	mf_functions[mf_functions_num].pos=(Bit8u*)cpos;
 	mf_functions[mf_functions_num].fct_ptr=current_simple_function;
 	mf_functions[mf_functions_num].ftype=flags_type;
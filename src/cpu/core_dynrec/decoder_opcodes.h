@@ -807,7 +807,7 @@ static bool dyn_grp4_eb(void) {
 		gen_mov_direct_dword(&core_dynrec.callback,decode_fetchw());
 		dyn_set_eip_end();
 		dyn_reduce_cycles();
-		dyn_return(BR_CallBack);
+		dyn_return(BlockReturn::CallBack);
 		dyn_closeblock();
 		return true;
 	default:
@@ -983,7 +983,7 @@ static bool dyn_grp7(void) {
 				dyn_check_exception(FC_RETOP);
 				dyn_set_eip_end();
 				dyn_reduce_cycles();
-				dyn_return(BR_Normal);
+				dyn_return(BlockReturn::Normal);
 				dyn_closeblock();
 				return true;
 			case 0x07:	// INVLPG
@@ -1005,7 +1005,7 @@ static bool dyn_grp7(void) {
 				dyn_check_exception(FC_RETOP);
 				dyn_set_eip_end();
 				dyn_reduce_cycles();
-				dyn_return(BR_Normal);
+				dyn_return(BlockReturn::Normal);
 				dyn_closeblock();
 				return true;
 			default: IllegalOptionDynrec("dyn_grp7_2");
@@ -1050,7 +1050,7 @@ static void dyn_mov_to_crx(void) {
 	dyn_check_exception(FC_RETOP);
 	dyn_set_eip_end();
 	dyn_reduce_cycles();
-	dyn_return(BR_Normal);
+	dyn_return(BlockReturn::Normal);
 	dyn_closeblock();
 }
 
@@ -1182,7 +1182,7 @@ static void dyn_ret_near(Bitu bytes) {
 	gen_mov_word_from_reg(FC_RETOP,decode.big_op?(void*)(&reg_eip):(void*)(&reg_ip),true);
 
 	if (bytes) gen_add_direct_word(&reg_esp,bytes,true);
-	dyn_return(BR_Normal);
+	dyn_return(BlockReturn::Normal);
 	dyn_closeblock();
 }
 
@@ -1206,7 +1206,7 @@ static void dyn_ret_far(Bitu bytes) {
 	dyn_reduce_cycles();
 	dyn_set_eip_last_end(FC_RETOP);
 	gen_call_function_IIR((void*)&CPU_RET,decode.big_op,bytes,FC_RETOP);
-	dyn_return(BR_Normal);
+	dyn_return(BlockReturn::Normal);
 	dyn_closeblock();
 }
 
@@ -1217,7 +1217,7 @@ static void dyn_call_far_imm(void) {
 	dyn_reduce_cycles();
 	dyn_set_eip_last_end(FC_RETOP);
 	gen_call_function_IIIR((void*)&CPU_CALL,decode.big_op,sel,off,FC_RETOP);
-	dyn_return(BR_Normal);
+	dyn_return(BlockReturn::Normal);
 	dyn_closeblock();
 }
 
@@ -1228,7 +1228,7 @@ static void dyn_jmp_far_imm(void) {
 	dyn_reduce_cycles();
 	dyn_set_eip_last_end(FC_RETOP);
 	gen_call_function_IIIR((void*)&CPU_JMP,decode.big_op,sel,off,FC_RETOP);
-	dyn_return(BR_Normal);
+	dyn_return(BlockReturn::Normal);
 	dyn_closeblock();
 }
 
@@ -1236,7 +1236,7 @@ static void dyn_iret(void) {
 	dyn_reduce_cycles();
 	dyn_set_eip_last_end(FC_RETOP);
 	gen_call_function_IR((void*)&CPU_IRET,decode.big_op,FC_RETOP);
-	dyn_return(BR_Iret);
+	dyn_return(BlockReturn::Iret);
 	dyn_closeblock();
 }
 
@@ -1244,7 +1244,7 @@ static void dyn_interrupt(Bit8u num) {
 	dyn_reduce_cycles();
 	dyn_set_eip_last_end(FC_RETOP);
 	gen_call_function_IIR((void*)&CPU_Interrupt,num,CPU_INT_SOFTWARE,FC_RETOP);
-	dyn_return(BR_Normal);
+	dyn_return(BlockReturn::Normal);
 	dyn_closeblock();
 }
 
@@ -395,41 +395,41 @@ static void dyn_dop_byte_gencall(DualOps op) {
 	switch (op) {
 		case DOP_ADD:
 			InvalidateFlags((void*)&dynrec_add_byte_simple,t_ADDb);
-			gen_call_function_raw((void*)&dynrec_add_byte);
+			gen_call_function_pure((void*)&dynrec_add_byte);
 			break;
 		case DOP_ADC:
 			AcquireFlags(FLAG_CF);
 			InvalidateFlagsPartially((void*)&dynrec_adc_byte_simple,t_ADCb);
-			gen_call_function_raw((void*)&dynrec_adc_byte);
+			gen_call_function_pure((void*)&dynrec_adc_byte);
 			break;
 		case DOP_SUB:
 			InvalidateFlags((void*)&dynrec_sub_byte_simple,t_SUBb);
-			gen_call_function_raw((void*)&dynrec_sub_byte);
+			gen_call_function_pure((void*)&dynrec_sub_byte);
 			break;
 		case DOP_SBB:
 			AcquireFlags(FLAG_CF);
 			InvalidateFlagsPartially((void*)&dynrec_sbb_byte_simple,t_SBBb);
-			gen_call_function_raw((void*)&dynrec_sbb_byte);
+			gen_call_function_pure((void*)&dynrec_sbb_byte);
 			break;
 		case DOP_CMP:
 			InvalidateFlags((void*)&dynrec_cmp_byte_simple,t_CMPb);
-			gen_call_function_raw((void*)&dynrec_cmp_byte);
+			gen_call_function_pure((void*)&dynrec_cmp_byte);
 			break;
 		case DOP_XOR:
 			InvalidateFlags((void*)&dynrec_xor_byte_simple,t_XORb);
-			gen_call_function_raw((void*)&dynrec_xor_byte);
+			gen_call_function_pure((void*)&dynrec_xor_byte);
 			break;
 		case DOP_AND:
 			InvalidateFlags((void*)&dynrec_and_byte_simple,t_ANDb);
-			gen_call_function_raw((void*)&dynrec_and_byte);
+			gen_call_function_pure((void*)&dynrec_and_byte);
 			break;
 		case DOP_OR:
 			InvalidateFlags((void*)&dynrec_or_byte_simple,t_ORb);
-			gen_call_function_raw((void*)&dynrec_or_byte);
+			gen_call_function_pure((void*)&dynrec_or_byte);
 			break;
 		case DOP_TEST:
 			InvalidateFlags((void*)&dynrec_test_byte_simple,t_TESTb);
-			gen_call_function_raw((void*)&dynrec_test_byte);
+			gen_call_function_pure((void*)&dynrec_test_byte);
 			break;
 		default: IllegalOptionDynrec("dyn_dop_byte_gencall");
 	}
@@ -440,41 +440,41 @@ static void dyn_dop_word_gencall(DualOps op,bool dword) {
 		switch (op) {
 			case DOP_ADD:
 				InvalidateFlags((void*)&dynrec_add_dword_simple,t_ADDd);
-				gen_call_function_raw((void*)&dynrec_add_dword);
+				gen_call_function_pure((void*)&dynrec_add_dword);
 				break;
 			case DOP_ADC:
 				AcquireFlags(FLAG_CF);
 				InvalidateFlagsPartially((void*)&dynrec_adc_dword_simple,t_ADCd);
-				gen_call_function_raw((void*)&dynrec_adc_dword);
+				gen_call_function_pure((void*)&dynrec_adc_dword);
 				break;
 			case DOP_SUB:
 				InvalidateFlags((void*)&dynrec_sub_dword_simple,t_SUBd);
-				gen_call_function_raw((void*)&dynrec_sub_dword);
+				gen_call_function_pure((void*)&dynrec_sub_dword);
 				break;
 			case DOP_SBB:
 				AcquireFlags(FLAG_CF);
 				InvalidateFlagsPartially((void*)&dynrec_sbb_dword_simple,t_SBBd);
-				gen_call_function_raw((void*)&dynrec_sbb_dword);
+				gen_call_function_pure((void*)&dynrec_sbb_dword);
 				break;
 			case DOP_CMP:
 				InvalidateFlags((void*)&dynrec_cmp_dword_simple,t_CMPd);
-				gen_call_function_raw((void*)&dynrec_cmp_dword);
+				gen_call_function_pure((void*)&dynrec_cmp_dword);
 				break;
 			case DOP_XOR:
 				InvalidateFlags((void*)&dynrec_xor_dword_simple,t_XORd);
-				gen_call_function_raw((void*)&dynrec_xor_dword);
+				gen_call_function_pure((void*)&dynrec_xor_dword);
 				break;
 			case DOP_AND:
 				InvalidateFlags((void*)&dynrec_and_dword_simple,t_ANDd);
-				gen_call_function_raw((void*)&dynrec_and_dword);
+				gen_call_function_pure((void*)&dynrec_and_dword);
 				break;
 			case DOP_OR:
 				InvalidateFlags((void*)&dynrec_or_dword_simple,t_ORd);
-				gen_call_function_raw((void*)&dynrec_or_dword);
+				gen_call_function_pure((void*)&dynrec_or_dword);
 				break;
 			case DOP_TEST:
 				InvalidateFlags((void*)&dynrec_test_dword_simple,t_TESTd);
-				gen_call_function_raw((void*)&dynrec_test_dword);
+				gen_call_function_pure((void*)&dynrec_test_dword);
 				break;
 			default: IllegalOptionDynrec("dyn_dop_dword_gencall");
 		}
@@ -482,41 +482,41 @@ static void dyn_dop_word_gencall(DualOps op,bool dword) {
 		switch (op) {
 			case DOP_ADD:
 				InvalidateFlags((void*)&dynrec_add_word_simple,t_ADDw);
-				gen_call_function_raw((void*)&dynrec_add_word);
+				gen_call_function_pure((void*)&dynrec_add_word);
 				break;
 			case DOP_ADC:
 				AcquireFlags(FLAG_CF);
 				InvalidateFlagsPartially((void*)&dynrec_adc_word_simple,t_ADCw);
-				gen_call_function_raw((void*)&dynrec_adc_word);
+				gen_call_function_pure((void*)&dynrec_adc_word);
 				break;
 			case DOP_SUB:
 				InvalidateFlags((void*)&dynrec_sub_word_simple,t_SUBw);
-				gen_call_function_raw((void*)&dynrec_sub_word);
+				gen_call_function_pure((void*)&dynrec_sub_word);
 				break;
 			case DOP_SBB:
 				AcquireFlags(FLAG_CF);
 				InvalidateFlagsPartially((void*)&dynrec_sbb_word_simple,t_SBBw);
-				gen_call_function_raw((void*)&dynrec_sbb_word);
+				gen_call_function_pure((void*)&dynrec_sbb_word);
 				break;
 			case DOP_CMP:
 				InvalidateFlags((void*)&dynrec_cmp_word_simple,t_CMPw);
-				gen_call_function_raw((void*)&dynrec_cmp_word);
+				gen_call_function_pure((void*)&dynrec_cmp_word);
 				break;
 			case DOP_XOR:
 				InvalidateFlags((void*)&dynrec_xor_word_simple,t_XORw);
-				gen_call_function_raw((void*)&dynrec_xor_word);
+				gen_call_function_pure((void*)&dynrec_xor_word);
 				break;
 			case DOP_AND:
 				InvalidateFlags((void*)&dynrec_and_word_simple,t_ANDw);
-				gen_call_function_raw((void*)&dynrec_and_word);
+				gen_call_function_pure((void*)&dynrec_and_word);
 				break;
 			case DOP_OR:
 				InvalidateFlags((void*)&dynrec_or_word_simple,t_ORw);
-				gen_call_function_raw((void*)&dynrec_or_word);
+				gen_call_function_pure((void*)&dynrec_or_word);
 				break;
 			case DOP_TEST:
 				InvalidateFlags((void*)&dynrec_test_word_simple,t_TESTw);
-				gen_call_function_raw((void*)&dynrec_test_word);
+				gen_call_function_pure((void*)&dynrec_test_word);
 				break;
 			default: IllegalOptionDynrec("dyn_dop_word_gencall");
 		}
@@ -667,18 +667,18 @@ static void dyn_sop_byte_gencall(SingleOps op) {
 	switch (op) {
 		case SOP_INC:
 			InvalidateFlagsPartially((void*)&dynrec_inc_byte_simple,t_INCb);
-			gen_call_function_raw((void*)&dynrec_inc_byte);
+			gen_call_function_pure((void*)&dynrec_inc_byte);
 			break;
 		case SOP_DEC:
 			InvalidateFlagsPartially((void*)&dynrec_dec_byte_simple,t_DECb);
-			gen_call_function_raw((void*)&dynrec_dec_byte);
+			gen_call_function_pure((void*)&dynrec_dec_byte);
 			break;
 		case SOP_NOT:
-			gen_call_function_raw((void*)&dynrec_not_byte);
+			gen_call_function_pure((void*)&dynrec_not_byte);
 			break;
 		case SOP_NEG:
 			InvalidateFlags((void*)&dynrec_neg_byte_simple,t_NEGb);
-			gen_call_function_raw((void*)&dynrec_neg_byte);
+			gen_call_function_pure((void*)&dynrec_neg_byte);
 			break;
 		default: IllegalOptionDynrec("dyn_sop_byte_gencall");
 	}
@@ -689,18 +689,18 @@ static void dyn_sop_word_gencall(SingleOps op,bool dword) {
 		switch (op) {
 			case SOP_INC:
 				InvalidateFlagsPartially((void*)&dynrec_inc_dword_simple,t_INCd);
-				gen_call_function_raw((void*)&dynrec_inc_dword);
+				gen_call_function_pure((void*)&dynrec_inc_dword);
 				break;
 			case SOP_DEC:
 				InvalidateFlagsPartially((void*)&dynrec_dec_dword_simple,t_DECd);
-				gen_call_function_raw((void*)&dynrec_dec_dword);
+				gen_call_function_pure((void*)&dynrec_dec_dword);
 				break;
 			case SOP_NOT:
-				gen_call_function_raw((void*)&dynrec_not_dword);
+				gen_call_function_pure((void*)&dynrec_not_dword);
 				break;
 			case SOP_NEG:
 				InvalidateFlags((void*)&dynrec_neg_dword_simple,t_NEGd);
-				gen_call_function_raw((void*)&dynrec_neg_dword);
+				gen_call_function_pure((void*)&dynrec_neg_dword);
 				break;
 			default: IllegalOptionDynrec("dyn_sop_dword_gencall");
 		}
@@ -708,18 +708,18 @@ static void dyn_sop_word_gencall(SingleOps op,bool dword) {
 		switch (op) {
 			case SOP_INC:
 				InvalidateFlagsPartially((void*)&dynrec_inc_word_simple,t_INCw);
-				gen_call_function_raw((void*)&dynrec_inc_word);
+				gen_call_function_pure((void*)&dynrec_inc_word);
 				break;
 			case SOP_DEC:
 				InvalidateFlagsPartially((void*)&dynrec_dec_word_simple,t_DECw);
-				gen_call_function_raw((void*)&dynrec_dec_word);
+				gen_call_function_pure((void*)&dynrec_dec_word);
 				break;
 			case SOP_NOT:
-				gen_call_function_raw((void*)&dynrec_not_word);
+				gen_call_function_pure((void*)&dynrec_not_word);
 				break;
 			case SOP_NEG:
 				InvalidateFlags((void*)&dynrec_neg_word_simple,t_NEGw);
-				gen_call_function_raw((void*)&dynrec_neg_word);
+				gen_call_function_pure((void*)&dynrec_neg_word);
 				break;
 			default: IllegalOptionDynrec("dyn_sop_word_gencall");
 		}
@@ -1115,32 +1115,32 @@ static void dyn_shift_byte_gencall(ShiftOps op) {
 	switch (op) {
 		case SHIFT_ROL:
 			InvalidateFlagsPartially((void*)&dynrec_rol_byte_simple,t_ROLb);
-			gen_call_function_raw((void*)&dynrec_rol_byte);
+			gen_call_function_pure((void*)&dynrec_rol_byte);
 			break;
 		case SHIFT_ROR:
 			InvalidateFlagsPartially((void*)&dynrec_ror_byte_simple,t_RORb);
-			gen_call_function_raw((void*)&dynrec_ror_byte);
+			gen_call_function_pure((void*)&dynrec_ror_byte);
 			break;
 		case SHIFT_RCL:
 			AcquireFlags(FLAG_CF);
-			gen_call_function_raw((void*)&dynrec_rcl_byte);
+			gen_call_function_pure((void*)&dynrec_rcl_byte);
 			break;
 		case SHIFT_RCR:
 			AcquireFlags(FLAG_CF);
-			gen_call_function_raw((void*)&dynrec_rcr_byte);
+			gen_call_function_pure((void*)&dynrec_rcr_byte);
 			break;
 		case SHIFT_SHL:
 		case SHIFT_SAL:
 			InvalidateFlagsPartially((void*)&dynrec_shl_byte_simple,t_SHLb);
-			gen_call_function_raw((void*)&dynrec_shl_byte);
+			gen_call_function_pure((void*)&dynrec_shl_byte);
 			break;
 		case SHIFT_SHR:
 			InvalidateFlagsPartially((void*)&dynrec_shr_byte_simple,t_SHRb);
-			gen_call_function_raw((void*)&dynrec_shr_byte);
+			gen_call_function_pure((void*)&dynrec_shr_byte);
 			break;
 		case SHIFT_SAR:
 			InvalidateFlagsPartially((void*)&dynrec_sar_byte_simple,t_SARb);
-			gen_call_function_raw((void*)&dynrec_sar_byte);
+			gen_call_function_pure((void*)&dynrec_sar_byte);
 			break;
 		default: IllegalOptionDynrec("dyn_shift_byte_gencall");
 	}
@@ -1151,32 +1151,32 @@ static void dyn_shift_word_gencall(ShiftOps op,bool dword) {
 		switch (op) {
 			case SHIFT_ROL:
 				InvalidateFlagsPartially((void*)&dynrec_rol_dword_simple,t_ROLd);
-				gen_call_function_raw((void*)&dynrec_rol_dword);
+				gen_call_function_pure((void*)&dynrec_rol_dword);
 				break;
 			case SHIFT_ROR:
 				InvalidateFlagsPartially((void*)&dynrec_ror_dword_simple,t_RORd);
-				gen_call_function_raw((void*)&dynrec_ror_dword);
+				gen_call_function_pure((void*)&dynrec_ror_dword);
 				break;
 			case SHIFT_RCL:
 				AcquireFlags(FLAG_CF);
-				gen_call_function_raw((void*)&dynrec_rcl_dword);
+				gen_call_function_pure((void*)&dynrec_rcl_dword);
 				break;
 			case SHIFT_RCR:
 				AcquireFlags(FLAG_CF);
-				gen_call_function_raw((void*)&dynrec_rcr_dword);
+				gen_call_function_pure((void*)&dynrec_rcr_dword);
 				break;
 			case SHIFT_SHL:
 			case SHIFT_SAL:
 				InvalidateFlagsPartially((void*)&dynrec_shl_dword_simple,t_SHLd);
-				gen_call_function_raw((void*)&dynrec_shl_dword);
+				gen_call_function_pure((void*)&dynrec_shl_dword);
 				break;
 			case SHIFT_SHR:
 				InvalidateFlagsPartially((void*)&dynrec_shr_dword_simple,t_SHRd);
-				gen_call_function_raw((void*)&dynrec_shr_dword);
+				gen_call_function_pure((void*)&dynrec_shr_dword);
 				break;
 			case SHIFT_SAR:
 				InvalidateFlagsPartially((void*)&dynrec_sar_dword_simple,t_SARd);
-				gen_call_function_raw((void*)&dynrec_sar_dword);
+				gen_call_function_pure((void*)&dynrec_sar_dword);
 				break;
 			default: IllegalOptionDynrec("dyn_shift_dword_gencall");
 		}
@@ -1184,32 +1184,32 @@ static void dyn_shift_word_gencall(ShiftOps op,bool dword) {
 		switch (op) {
 			case SHIFT_ROL:
 				InvalidateFlagsPartially((void*)&dynrec_rol_word_simple,t_ROLw);
-				gen_call_function_raw((void*)&dynrec_rol_word);
+				gen_call_function_pure((void*)&dynrec_rol_word);
 				break;
 			case SHIFT_ROR:
 				InvalidateFlagsPartially((void*)&dynrec_ror_word_simple,t_RORw);
-				gen_call_function_raw((void*)&dynrec_ror_word);
+				gen_call_function_pure((void*)&dynrec_ror_word);
 				break;
 			case SHIFT_RCL:
 				AcquireFlags(FLAG_CF);
-				gen_call_function_raw((void*)&dynrec_rcl_word);
+				gen_call_function_pure((void*)&dynrec_rcl_word);
 				break;
 			case SHIFT_RCR:
 				AcquireFlags(FLAG_CF);
-				gen_call_function_raw((void*)&dynrec_rcr_word);
+				gen_call_function_pure((void*)&dynrec_rcr_word);
 				break;
 			case SHIFT_SHL:
 			case SHIFT_SAL:
 				InvalidateFlagsPartially((void*)&dynrec_shl_word_simple,t_SHLw);
-				gen_call_function_raw((void*)&dynrec_shl_word);
+				gen_call_function_pure((void*)&dynrec_shl_word);
 				break;
 			case SHIFT_SHR:
 				InvalidateFlagsPartially((void*)&dynrec_shr_word_simple,t_SHRw);
-				gen_call_function_raw((void*)&dynrec_shr_word);
+				gen_call_function_pure((void*)&dynrec_shr_word);
 				break;
 			case SHIFT_SAR:
 				InvalidateFlagsPartially((void*)&dynrec_sar_word_simple,t_SARw);
-				gen_call_function_raw((void*)&dynrec_sar_word);
+				gen_call_function_pure((void*)&dynrec_sar_word);
 				break;
 			default: IllegalOptionDynrec("dyn_shift_word_gencall");
 		}
@@ -1355,23 +1355,23 @@ static Bit32u DRC_CALL_CONV dynrec_get_nzf_and_sf_eq_of(void)	{ return TFLG_NLE;
 
 static void dyn_branchflag_to_reg(BranchTypes btype) {
 	switch (btype) {
-		case BR_O:gen_call_function_raw((void*)&dynrec_get_of);break;
-		case BR_NO:gen_call_function_raw((void*)&dynrec_get_nof);break;
-		case BR_B:gen_call_function_raw((void*)&dynrec_get_cf);break;
-		case BR_NB:gen_call_function_raw((void*)&dynrec_get_ncf);break;
-		case BR_Z:gen_call_function_raw((void*)&dynrec_get_zf);break;
-		case BR_NZ:gen_call_function_raw((void*)&dynrec_get_nzf);break;
-		case BR_BE:gen_call_function_raw((void*)&dynrec_get_cf_or_zf);break;
-		case BR_NBE:gen_call_function_raw((void*)&dynrec_get_ncf_and_nzf);break;
-
-		case BR_S:gen_call_function_raw((void*)&dynrec_get_sf);break;
-		case BR_NS:gen_call_function_raw((void*)&dynrec_get_nsf);break;
-		case BR_P:gen_call_function_raw((void*)&dynrec_get_pf);break;
-		case BR_NP:gen_call_function_raw((void*)&dynrec_get_npf);break;
-		case BR_L:gen_call_function_raw((void*)&dynrec_get_sf_neq_of);break;
-		case BR_NL:gen_call_function_raw((void*)&dynrec_get_sf_eq_of);break;
-		case BR_LE:gen_call_function_raw((void*)&dynrec_get_zf_or_sf_neq_of);break;
-		case BR_NLE:gen_call_function_raw((void*)&dynrec_get_nzf_and_sf_eq_of);break;
+		case BR_O:gen_call_function_pure((void*)&dynrec_get_of);break;
+		case BR_NO:gen_call_function_pure((void*)&dynrec_get_nof);break;
+		case BR_B:gen_call_function_pure((void*)&dynrec_get_cf);break;
+		case BR_NB:gen_call_function_pure((void*)&dynrec_get_ncf);break;
+		case BR_Z:gen_call_function_pure((void*)&dynrec_get_zf);break;
+		case BR_NZ:gen_call_function_pure((void*)&dynrec_get_nzf);break;
+		case BR_BE:gen_call_function_pure((void*)&dynrec_get_cf_or_zf);break;
+		case BR_NBE:gen_call_function_pure((void*)&dynrec_get_ncf_and_nzf);break;
+
+		case BR_S:gen_call_function_pure((void*)&dynrec_get_sf);break;
+		case BR_NS:gen_call_function_pure((void*)&dynrec_get_nsf);break;
+		case BR_P:gen_call_function_pure((void*)&dynrec_get_pf);break;
+		case BR_NP:gen_call_function_pure((void*)&dynrec_get_npf);break;
+		case BR_L:gen_call_function_pure((void*)&dynrec_get_sf_neq_of);break;
+		case BR_NL:gen_call_function_pure((void*)&dynrec_get_sf_eq_of);break;
+		case BR_LE:gen_call_function_pure((void*)&dynrec_get_zf_or_sf_neq_of);break;
+		case BR_NLE:gen_call_function_pure((void*)&dynrec_get_nzf_and_sf_eq_of);break;
 	}
 }
 
@@ -36,6 +36,13 @@
 #define DRC_CALL_CONV	/* nothing */
 #define DRC_FC			/* nothing */
 
+// use FC_REGS_ADDR to hold the address of "cpu_regs" and to access it using FC_REGS_ADDR
+#define DRC_USE_REGS_ADDR
+// keep guest registers in host registers within a block, see gen_regcache_get
+#define DRC_USE_REGS_CACHE
+// host addresses in the generated code are noted with cache_addreloc
+#define DRC_USE_RELOCATIONS
+
 
 // register mapping
 typedef Bit8u HostReg;
@@ -44,10 +51,14 @@ typedef Bit8u HostReg;
 #define HOST_ECX 1
 #define HOST_EDX 2
 #define HOST_EBX 3
+#define HOST_EBP 5
 #define HOST_ESI 6
 #define HOST_EDI 7
 
 
+// the parameter registers below follow the System V AMD64 ABI,
+// the Win64 calling convention is not supported by this backend
+
 // register that holds function return values
 #define FC_RETOP HOST_EAX
 
@@ -75,13 +86,30 @@ typedef Bit8u HostReg;
 // temporary register for LEA
 #define TEMP_REG_DRC HOST_ESI
 
+// register that holds the address of cpu_regs, set up by gen_run_code
+#define FC_REGS_ADDR HOST_EBP
+
+// number of guest registers that can be held in r12-r15
+#define DRC_REGS_CACHED 4
+
+
+// how an address noted with cache_addreloc is encoded
+enum {
+	RELOC_ABS64,		// 64bit address
+	RELOC_ABS32,		// 32bit address below 4GB
+	RELOC_REGS8,		// 8bit displacement from FC_REGS_ADDR
+	RELOC_REGS32,		// 32bit displacement from FC_REGS_ADDR
+	RELOC_RIP32			// 32bit RIP-relative displacement, plus the bytes of
+						// the instruction that follow it (0,1,2 or 4)
+};
+
 
 // move a full register from reg_src to reg_dst
-static void gen_mov_regs(HostReg reg_dst, HostReg reg_src) {
-    if (reg_dst == reg_src) return; // Skip if source and destination are the same
-    cache_addb(0x48 | ((reg_dst >= 8) << 2) | (reg_src >= 8)); // REX.W + REX.R + REX.B
-    cache_addb(0x8b);
-    cache_addb(0xc0 + ((reg_dst & 7) << 3) + (reg_src & 7));
+static void gen_mov_regs(HostReg reg_dst,HostReg reg_src) {
+	if (reg_dst==reg_src) return;
+	cache_addb(0x48);
+	cache_addb(0x8b);					// mov reg_dst,reg_src
+	cache_addb(0xc0+(reg_dst<<3)+reg_src);
 }
 
 // move a 64bit constant value into a full register
@@ -89,76 +117,207 @@ static void gen_mov_reg_qword(HostReg dest_reg,Bit64u imm) {
 	cache_addb(0x48);
 	cache_addb(0xb8+dest_reg);			// mov dest_reg,imm
 	cache_addq(imm);
+	cache_addreloc(cache.pos-8,RELOC_ABS64,(void*)imm);
+}
+
+
+// Guest registers that are used by a block are held in r12-r15 once they
+// have been read or written, and only stored back to cpu_regs when a slot
+// is needed for another register, before helper functions that can access
+// the registers, before branches and when the block is left. The state below
+// describes the code that is being generated, it is reset for every block.
+static struct {
+	Bit8u slot[8];					// slot+1 that holds the guest register, 0 if not cached
+	Bit8u guest[DRC_REGS_CACHED];	// guest register+1 held in the slot, 0 if the slot is free
+	bool dirty[DRC_REGS_CACHED];	// slot was changed and has to be stored back
+	Bitu used[DRC_REGS_CACHED];		// time of the last access, the oldest slot is replaced
+	Bitu time;
+} regcache;
+
+// lowest 3 bits of the host register of a slot (r12-r15, needs REX.R or REX.B)
+#define REGCACHE_HOSTREG(slot) (4+(slot))
+
+// store the value of a slot into cpu_regs
+static void gen_regcache_store(Bitu slot) {
+	cache_addb(0x44);
+	cache_addb(0x89);					// mov [FC_REGS_ADDR+index],r12d-r15d
+	cache_addb(0x40+(REGCACHE_HOSTREG(slot)<<3)+FC_REGS_ADDR);
+	cache_addb((regcache.guest[slot]-1)*4);
+}
+
+// store all changed slots into cpu_regs, the slots stay valid; if mark_clean
+// is false the stores are only done on the path that is generated next
+static void gen_regcache_writeback(bool mark_clean=true) {
+	for (Bitu slot=0;slot<DRC_REGS_CACHED;slot++) {
+		if (!regcache.guest[slot] || !regcache.dirty[slot]) continue;
+		gen_regcache_store(slot);
+		if (mark_clean) regcache.dirty[slot]=false;
+	}
+}
+
+static bool regcache_is_dirty(void) {
+	for (Bitu slot=0;slot<DRC_REGS_CACHED;slot++) {
+		if (regcache.guest[slot] && regcache.dirty[slot]) return true;
+	}
+	return false;
+}
+
+// forget all slots, code that follows has to reload them from cpu_regs
+static void gen_regcache_clear(void) {
+	memset(&regcache,0,sizeof(regcache));
+}
+
+// store changed slots and forget all of them
+static void gen_regcache_flush(void) {
+	gen_regcache_writeback();
+	gen_regcache_clear();
+}
+
+// store the guest register if it is changed and forget its slot
+static void gen_regcache_drop(Bitu reg) {
+	if (!regcache.slot[reg]) return;
+	Bitu slot=regcache.slot[reg]-1;
+	if (regcache.dirty[slot]) gen_regcache_store(slot);
+	regcache.guest[slot]=0;
+	regcache.dirty[slot]=false;
+	regcache.slot[reg]=0;
+}
+
+// get the slot that holds the guest register, a new slot is loaded
+// from cpu_regs only if load is true (the register is overwritten otherwise)
+static Bitu gen_regcache_get(Bitu reg,bool load) {
+	Bitu slot;
+	if (regcache.slot[reg]) {
+		slot=regcache.slot[reg]-1;
+		regcache.used[slot]=++regcache.time;
+		return slot;
+	}
+	slot=0;
+	for (Bitu ct=0;ct<DRC_REGS_CACHED;ct++) {
+		if (!regcache.guest[ct]) {
+			slot=ct;
+			break;
+		}
+		if (regcache.used[ct]<regcache.used[slot]) slot=ct;
+	}
+	if (regcache.guest[slot]) gen_regcache_drop(regcache.guest[slot]-1);
+
+	regcache.guest[slot]=(Bit8u)(reg+1);
+	regcache.slot[reg]=(Bit8u)(slot+1);
+	regcache.dirty[slot]=false;
+	regcache.used[slot]=++regcache.time;
+	if (load) {
+		cache_addb(0x44);
+		cache_addb(0x8b);				// mov r12d-r15d,[FC_REGS_ADDR+index]
+		cache_addb(0x40+(REGCACHE_HOSTREG(slot)<<3)+FC_REGS_ADDR);
+		cache_addb(reg*4);
+	}
+	return slot;
 }
 
 
 // This function generates an instruction with register addressing and a memory location
-static void gen_reg_memaddr(HostReg reg, void* data, Bit8u op, Bit8u prefix = 0) {
-    Bit64s diff = (Bit64s)data - ((Bit64s)cache.pos + (prefix ? 7 : 6));
-    if ((diff >> 31) == (diff >> 63)) { // RIP-relative
-        if (prefix) cache_addb(prefix);
-        cache_addb(op);
-        cache_addb(0x05 + ((reg & 7) << 3));
-        if (reg >= 8) cache_addb(0x41); // REX.R for extended registers
-        cache_addd((Bit32u)(diff & 0xffffffff));
-    } else if ((Bit64u)data < 0x100000000ULL) { // Absolute <4GB
-        if (prefix) cache_addb(prefix);
-        cache_addb(op);
-        cache_addw(0x2504 + ((reg & 7) << 3));
-        if (reg >= 8) cache_addb(0x41);
-        cache_addd((Bit32u)((Bit64u)data & 0xffffffff));
-    } else { // Full 64-bit address
-        HostReg tmp_reg = HOST_R9;
-        if (reg == HOST_R9) tmp_reg = HOST_RCX;
-        gen_mov_reg_qword(tmp_reg, (Bit64u)data);
-        if (prefix) cache_addb(prefix);
-        cache_addb(op);
-        cache_addb((reg << 3) + tmp_reg);
-    }
+static INLINE void gen_reg_memaddr(HostReg reg,void* data,Bit8u op,Bit8u prefix=0) {
+	Bit64s regs_diff=(Bit64s)data-(Bit64s)&cpu_regs;
+	Bit64s diff=(Bit64s)data-((Bit64s)cache.pos+(prefix?7:6));
+	if ((regs_diff>>63)==(regs_diff>>31)) {
+		// the data is close to cpu_regs (all emulator globals are),
+		// address it relative to FC_REGS_ADDR
+		if (prefix) cache_addb(prefix);
+		cache_addb(op);
+		if (regs_diff>=-128 && regs_diff<=127) {
+			cache_addb(0x40+(reg<<3)+FC_REGS_ADDR);
+			cache_addb((Bit8u)regs_diff);
+			cache_addreloc(cache.pos-1,RELOC_REGS8,data,true);
+		} else {
+			cache_addb(0x80+(reg<<3)+FC_REGS_ADDR);
+			cache_addd((Bit32u)(((Bit64u)regs_diff)&0xffffffffLL));
+			cache_addreloc(cache.pos-4,RELOC_REGS32,data,true);
+		}
+	} else if ((diff>>63)==(diff>>31)) {
+		// the displacement fits into a signed 32bit value,
+		// use RIP-relative addressing (offset is from the end of the instruction)
+		if (prefix) cache_addb(prefix);
+		cache_addb(op);
+		cache_addb(0x05+(reg<<3));
+		cache_addd((Bit32u)(((Bit64u)diff)&0xffffffffLL));
+		cache_addreloc(cache.pos-4,RELOC_RIP32,data);
+	} else if ((Bit64u)data<0x100000000LL) {
+		// absolute address of data is below 4GB
+		if (prefix) cache_addb(prefix);
+		cache_addb(op);
+		cache_addw(0x2504+(reg<<3));
+		cache_addd((Bit32u)(((Bit64u)data)&0xffffffffLL));
+		cache_addreloc(cache.pos-4,RELOC_ABS32,data);
+	} else {
+		// load the 64bit address into a temporary register
+		HostReg tmp_reg=HOST_EAX;
+		if (reg==HOST_EAX) tmp_reg=HOST_ECX;
+
+		cache_addb(0x50+tmp_reg);			// push rax/rcx
+		gen_mov_reg_qword(tmp_reg,(Bit64u)data);
+
+		if (prefix) cache_addb(prefix);
+		cache_addb(op);
+		cache_addb(tmp_reg+(reg<<3));		// op reg,[tmp_reg]
+
+		cache_addb(0x58+tmp_reg);			// pop rax/rcx
+	}
 }
 
 // Same as above, but with immediate addressing and a memory location
-static void gen_memaddr(Bitu modreg, void* data, Bitu off, Bitu imm, Bit8u op, Bit8u prefix = 0) {
-    Bit64s diff = (Bit64s)data - ((Bit64s)cache.pos + off + (prefix ? 7 : 6));
-    if ((diff >> 31) == (diff >> 63)) { // RIP-relative
-        if (prefix) cache_addb(prefix);
-        cache_addw(op + ((modreg + 1) << 8));
-        cache_addd((Bit32u)(diff & 0xffffffff));
-        switch (off) {
-            case 1: cache_addb((Bit8u)imm); break;
-            case 2: cache_addw((Bit16u)imm); break;
-            case 4: cache_addd((Bit32u)imm); break;
-        }
-    } else if ((Bit64u)data < 0x100000000ULL) { // Absolute <4GB
-        if (prefix) cache_addb(prefix);
-        cache_addw(op + (modreg << 8));
-        cache_addb(0x25);
-        cache_addd((Bit32u)((Bit64u)data & 0xffffffff));
-        switch (off) {
-            case 1: cache_addb((Bit8u)imm); break;
-            case 2: cache_addw((Bit16u)imm); break;
-            case 4: cache_addd((Bit32u)imm); break;
-        }
-    } else { // Full 64-bit address
-        gen_mov_reg_qword(HOST_R9, (Bit64u)data);
-        if (prefix) cache_addb(prefix);
-        cache_addw(op + ((modreg - 4 + HOST_R9) << 8));
-        switch (off) {
-            case 1: cache_addb((Bit8u)imm); break;
-            case 2: cache_addw((Bit16u)imm); break;
-            case 4: cache_addd((Bit32u)imm); break;
-        }
-    }
+static INLINE void gen_memaddr(Bitu modreg,void* data,Bitu off,Bitu imm,Bit8u op,Bit8u prefix=0) {
+	Bit64s regs_diff=(Bit64s)data-(Bit64s)&cpu_regs;
+	Bit64s diff=(Bit64s)data-((Bit64s)cache.pos+off+(prefix?7:6));
+	bool restore_rax=false;
+	if ((regs_diff>>63)==(regs_diff>>31)) {
+		// address relative to FC_REGS_ADDR
+		if (prefix) cache_addb(prefix);
+		if (regs_diff>=-128 && regs_diff<=127) {
+			cache_addw(op+((modreg-4+0x40+FC_REGS_ADDR)<<8));
+			cache_addb((Bit8u)regs_diff);
+			cache_addreloc(cache.pos-1,RELOC_REGS8,data,true);
+		} else {
+			cache_addw(op+((modreg-4+0x80+FC_REGS_ADDR)<<8));
+			cache_addd((Bit32u)(((Bit64u)regs_diff)&0xffffffffLL));
+			cache_addreloc(cache.pos-4,RELOC_REGS32,data,true);
+		}
+	} else if ((diff>>63)==(diff>>31)) {
+		// RIP-relative addressing (offset is from the end of the instruction)
+		if (prefix) cache_addb(prefix);
+		cache_addw(op+((modreg+1)<<8));
+		cache_addd((Bit32u)(((Bit64u)diff)&0xffffffffLL));
+		cache_addreloc(cache.pos-4,RELOC_RIP32+off,data);
+	} else if ((Bit64u)data<0x100000000LL) {
+		// absolute address of data is below 4GB
+		if (prefix) cache_addb(prefix);
+		cache_addw(op+(modreg<<8));
+		cache_addb(0x25);
+		cache_addd((Bit32u)(((Bit64u)data)&0xffffffffLL));
+		cache_addreloc(cache.pos-4,RELOC_ABS32,data);
+	} else {
+		// load the 64bit address into rax
+		cache_addb(0x50);					// push rax
+		gen_mov_reg_qword(HOST_EAX,(Bit64u)data);
+		if (prefix) cache_addb(prefix);
+		cache_addw(op+((modreg-4+HOST_EAX)<<8));	// op [rax],imm
+		restore_rax=true;
+	}
+
+	switch (off) {
+		case 1: cache_addb((Bit8u)imm); break;
+		case 2: cache_addw((Bit16u)imm); break;
+		case 4: cache_addd((Bit32u)imm); break;
+	}
+
+	if (restore_rax) cache_addb(0x58);		// pop rax
 }
 
 // move a 32bit (dword==true) or 16bit (dword==false) value from memory into dest_reg
 // 16bit moves may destroy the upper 16bit of the destination register
-static void gen_mov_word_to_reg(HostReg dest_reg, void* data, bool dword, Bit8u prefix = 0) {
-    cache_addb(0x0f); // prefetcht0 [data]
-    cache_addb(0x18);
-    cache_addb(0x05);
-    cache_addd((Bit32u)(((Bit64s)data - ((Bit64s)cache.pos + 4)) & 0xffffffff));
-    gen_reg_memaddr(dest_reg, data, dword ? 0x8b : 0xb7, prefix);
+static void gen_mov_word_to_reg(HostReg dest_reg,void* data,bool dword,Bit8u prefix=0) {
+	if (dword) gen_reg_memaddr(dest_reg,data,0x8b,prefix);	// mov reg,[data]
+	else gen_reg_memaddr(dest_reg,data,0xb7,0x0f);			// movzx reg,word[data]
 }
 
 // move a 16bit constant value into dest_reg
@@ -242,16 +401,10 @@ static void gen_add(HostReg reg,void* op) {
 }
 
 // add a 32bit constant value to a full register
-static void gen_and_imm(HostReg reg, Bit32u imm) {
-    if (imm <= 127) {
-        cache_addb(0x48 | (reg >= 8 ? 0x41 : 0));
-        cache_addw(0xe083 + ((reg & 7) << 8));
-        cache_addb((Bit8u)imm);
-    } else {
-        cache_addb(0x48 | (reg >= 8 ? 0x41 : 0));
-        cache_addw(0xe081 + ((reg & 7) << 8));
-        cache_addd(imm);
-    }
+static void gen_add_imm(HostReg reg,Bit32u imm) {
+	if (!imm) return;
+	cache_addw(0xc081+(reg<<8));		// add reg,imm
+	cache_addd(imm);
 }
 
 // and a 32bit constant value with a full register
@@ -291,7 +444,7 @@ static void gen_add_direct_word(void* dest,Bit32u imm,bool dword) {
 
 // subtract an 8bit constant value from a memory value
 static void gen_sub_direct_byte(void* dest,Bit8s imm) {
-	gen_memaddr(0x2c,dest,1,imm,0x83);
+	gen_memaddr(0x2c,dest,1,imm,0x83);	// sub [data],imm
 }
 
 // subtract a 32bit (dword==true) or 16bit (dword==false) constant value from a memory value
@@ -308,19 +461,28 @@ static void gen_sub_direct_word(void* dest,Bit32u imm,bool dword) {
 // effective address calculation, destination is dest_reg
 // scale_reg is scaled by scale (scale_reg*(2^scale)) and
 // added to dest_reg, then the immediate value is added
-static void gen_lea(HostReg dest_reg, HostReg scale_reg, Bitu scale, Bits imm) {
-    if (scale == 0 && imm <= 127 && imm >= -128) { // Optimize for scale=0
-        cache_addb(0x48 | ((dest_reg >= 8) << 2));
-        cache_addw(0xc083 + ((dest_reg & 7) << 8));
-        cache_addb((Bit8s)imm);
-        if (dest_reg != scale_reg) gen_mov_regs(dest_reg, scale_reg);
-        return;
-    }
-    cache_addb(0x48 | ((dest_reg >= 8) << 2) | (scale_reg >= 8));
-    cache_addb(0x8d);
-    cache_addb(0x04 + ((dest_reg & 7) << 3) + (imm ? 0x80 : 0));
-    cache_addb((dest_reg & 7) + ((scale_reg & 7) << 3) + (scale << 6));
-    if (imm) cache_addd(imm);
+static INLINE void gen_lea(HostReg dest_reg,HostReg scale_reg,Bitu scale,Bits imm) {
+	Bit8u rm_base;
+	Bitu imm_size;
+	if (!imm) {
+		imm_size=0;	rm_base=0x0;			//no imm
+	} else if ((imm>=-128 && imm<=127)) {
+		imm_size=1;	rm_base=0x40;			//Signed byte imm
+	} else {
+		imm_size=4;	rm_base=0x80;			//Signed dword imm
+	}
+
+	// ea_reg := ea_reg+scale_reg*(2^scale)+imm
+	cache_addb(0x48);
+	cache_addb(0x8d);			//LEA
+	cache_addb(0x04+(dest_reg << 3)+rm_base);	//The sib indicator
+	cache_addb(dest_reg+(scale_reg<<3)+(scale<<6));
+
+	switch (imm_size) {
+	case 0:	break;
+	case 1:cache_addb(imm);break;
+	case 4:cache_addd(imm);break;
+	}
 }
 
 // effective address calculation, destination is dest_reg
@@ -339,170 +501,118 @@ static INLINE void gen_lea(HostReg dest_reg,Bitu scale,Bits imm) {
 
 
 
+// generate a call to a parameterless function that does not access the
+// guest registers (flags and memory helpers), the cached registers stay valid
+// gen_fill_function_ptr relies on the layout of this sequence
+static void INLINE gen_call_function_pure(void * func) {
+	cache_addb(0x48);
+	cache_addw(0xec83);
+	cache_addb(0x08);		// sub rsp,0x08 (align stack to 16 byte boundary)
+
+	cache_addb(0x48);
+	cache_addb(0xb8);		// mov rax,imm64
+	cache_addq((Bit64u)func);
+	cache_addreloc(cache.pos-8,RELOC_ABS64,func);
+
+	cache_addw(0xd0ff);		// call rax
+
+	cache_addb(0x48);
+	cache_addw(0xc483);
+	cache_addb(0x08);		// add rsp,0x08 (reset alignment)
+}
+
 // generate a call to a parameterless function
-static void gen_call_function_raw(void* func) {
-    Bit64s diff = (Bit64s)func - ((Bit64s)cache.pos + 5);
-    if ((diff >> 31) == (diff >> 63)) { // Direct call
-        cache_addb(0xe8);
-        cache_addd((Bit32u)(diff & 0xffffffff));
-    } else { // Indirect call
-        gen_mov_reg_qword(HOST_RAX, (Bit64u)func);
-        cache_addw(0xd0ff);
-    }
+static void INLINE gen_call_function_raw(void * func) {
+	gen_regcache_flush();
+	gen_call_function_pure(func);
 }
 
 // generate a call to a function with paramcount parameters
 // note: the parameters are loaded in the architecture specific way
 // using the gen_load_param_ functions below
-static Bit64u gen_call_function_setup(void* func, Bitu paramcount, bool fastcall = false) {
-    cache_addb(0x50); // push rax
-    Bit64u proc_addr = (Bit64u)cache.pos;
-    gen_call_function_raw(func);
-    cache_addb(0x58); // pop rax
-    return proc_addr;
+static Bit64u INLINE gen_call_function_setup(void * func,Bitu paramcount,bool fastcall=false) {
+	// the function may access the guest registers
+	gen_regcache_flush();
+
+	// align the stack
+	cache_addb(0x48);
+	cache_addw(0xc48b);		// mov rax,rsp
+
+	cache_addb(0x48);
+	cache_addw(0xec83);
+	cache_addb(0x08);		// sub rsp,0x08
+	cache_addb(0x48);
+	cache_addw(0xe483);
+	cache_addb(0xf0);		// and rsp,0xfffffffffffffff0
+	cache_addb(0x48);
+	cache_addw(0xc483);
+	cache_addb(0x08);		// add rsp,0x08
+
+	// stack is 16 byte aligned after the push
+	cache_addb(0x50);		// push rax (==old rsp)
+
+	// returned address relates to where the address is stored in gen_call_function_raw
+	Bit64u proc_addr=(Bit64u)cache.pos-4;
+
+	// do the actual call to the procedure
+	cache_addb(0x48);
+	cache_addb(0xb8);		// mov rax,imm64
+	cache_addq((Bit64u)func);
+	cache_addreloc(cache.pos-8,RELOC_ABS64,func);
+
+	cache_addw(0xd0ff);		// call rax
+
+	// restore stack
+	cache_addb(0x5c);		// pop rsp
+
+	return proc_addr;
 }
 
-// load an immediate value as param'th function parameter
-static void INLINE gen_load_param_imm(Bitu imm,Bitu param) {
-	// move an immediate 32bit value into a 64bit param reg
+// register that holds the param'th function parameter
+static HostReg INLINE gen_param_reg(Bitu param) {
 	switch (param) {
-		case 0:			// mov param1,imm32
-			gen_mov_dword_to_reg_imm(FC_OP1,(Bit32u)imm);
-			break;
-		case 1:			// mov param2,imm32
-			gen_mov_dword_to_reg_imm(FC_OP2,(Bit32u)imm);
-			break;
-#if defined (_MSC_VER)
-		case 2:			// mov r8,imm32
-			cache_addw(0xb849);
-			cache_addq((Bit32u)imm);
-			break;
-		case 3:			// mov r9,imm32
-			cache_addw(0xb949);
-			cache_addq((Bit32u)imm);
-			break;
-#else
-		case 2:			// mov rdx,imm32
-			gen_mov_dword_to_reg_imm(HOST_EDX,(Bit32u)imm);
-			break;
-		case 3:			// mov rcx,imm32
-			gen_mov_dword_to_reg_imm(HOST_ECX,(Bit32u)imm);
-			break;
-#endif
+		case 0: return FC_OP1;		// rdi
+		case 1: return FC_OP2;		// rsi
+		case 2: return HOST_EDX;	// rdx
+		case 3: return HOST_ECX;	// rcx
 		default:
-			E_Exit("I(mm) >4 params unsupported");
-			break;
+			E_Exit(">4 params unsupported");
+			return FC_OP1;
 	}
 }
 
+// load an immediate value as param'th function parameter
+static void INLINE gen_load_param_imm(Bitu imm,Bitu param) {
+	gen_mov_dword_to_reg_imm(gen_param_reg(param),(Bit32u)imm);
+}
+
 // load an address as param'th function parameter
 static void INLINE gen_load_param_addr(DRC_PTR_SIZE_IM addr,Bitu param) {
-	// move an immediate 64bit value into a 64bit param reg
-	switch (param) {
-		case 0:			// mov param1,addr64
-			gen_mov_reg_qword(FC_OP1,addr);
-			break;
-		case 1:			// mov param2,addr64
-			gen_mov_reg_qword(FC_OP2,addr);
-			break;
-#if defined (_MSC_VER)
-		case 2:			// mov r8,addr64
-			cache_addw(0xb849);
-			cache_addq(addr);
-			break;
-		case 3:			// mov r9,addr64
-			cache_addw(0xb949);
-			cache_addq(addr);
-			break;
-#else
-		case 2:			// mov rdx,addr64
-			gen_mov_reg_qword(HOST_EDX,addr);
-			break;
-		case 3:			// mov rcx,addr64
-			gen_mov_reg_qword(HOST_ECX,addr);
-			break;
-#endif
-		default:
-			E_Exit("A(ddr) >4 params unsupported");
-			break;
-	}
+	gen_mov_reg_qword(gen_param_reg(param),addr);
 }
 
 // load a host-register as param'th function parameter
 static void INLINE gen_load_param_reg(Bitu reg,Bitu param) {
-	// move a register into a 64bit param reg, {inputregs}!={outputregs}
-	switch (param) {
-		case 0:		// mov param1,reg&7
-			gen_mov_regs(FC_OP1,reg&7);
-			break;
-		case 1:		// mov param2,reg&7
-			gen_mov_regs(FC_OP2,reg&7);
-			break;
-#if defined (_MSC_VER)
-		case 2:		// mov r8,reg&7
-			cache_addb(0x49);
-			gen_mov_regs(0,reg&7);
-			break;
-		case 3:		// mov r9,reg&7
-			cache_addb(0x49);
-			gen_mov_regs(1,reg&7);
-			break;
-#else
-		case 2:		// mov rdx,reg&7
-			gen_mov_regs(HOST_EDX,reg&7);
-			break;
-		case 3:		// mov rcx,reg&7
-			gen_mov_regs(HOST_ECX,reg&7);
-			break;
-#endif
-		default:
-			E_Exit("R(eg) >4 params unsupported");
-			break;
-	}
+	gen_mov_regs(gen_param_reg(param),(HostReg)reg);
 }
 
 // load a value from memory as param'th function parameter
 static void INLINE gen_load_param_mem(Bitu mem,Bitu param) {
-	// move memory content into a 64bit param reg
-	switch (param) {
-		case 0:		// mov param1,[mem]
-			gen_mov_word_to_reg(FC_OP1,(void*)mem,true);
-			break;
-		case 1:		// mov param2,[mem]
-			gen_mov_word_to_reg(FC_OP2,(void*)mem,true);
-			break;
-#if defined (_MSC_VER)
-		case 2:		// mov r8,[mem]
-			gen_mov_word_to_reg(0,(void*)mem,true,0x49);	// 0x49, use x64 rX regs
-			break;
-		case 3:		// mov r9,[mem]
-			gen_mov_word_to_reg(1,(void*)mem,true,0x49);	// 0x49, use x64 rX regs
-			break;
-#else
-		case 2:		// mov rdx,[mem]
-			gen_mov_word_to_reg(HOST_EDX,(void*)mem,true);
-			break;
-		case 3:		// mov rcx,[mem]
-			gen_mov_word_to_reg(HOST_ECX,(void*)mem,true);
-			break;
-#endif
-		default:
-			E_Exit("R(eg) >4 params unsupported");
-			break;
-	}
+	gen_mov_word_to_reg(gen_param_reg(param),(void*)mem,true);
 }
 
 
 
 // jump to an address pointed at by ptr, offset is in imm
 static void gen_jmp_ptr(void * ptr,Bits imm=0) {
-	cache_addw(0xa148);		// mov rax,[data]
-	cache_addq((Bit64u)ptr);
+	gen_regcache_flush();
+
+	gen_mov_word_to_reg(HOST_EAX,ptr,true,0x48);		// mov rax,[data]
 
 	cache_addb(0xff);		// jmp [rax+imm]
 	if (!imm) {
 		cache_addb(0x20);
-    } else if ((imm>=-128 && imm<=127)) {
+	} else if ((imm>=-128 && imm<=127)) {
 		cache_addb(0x60);
 		cache_addb(imm);
 	} else {
@@ -514,24 +624,28 @@ static void gen_jmp_ptr(void * ptr,Bits imm=0) {
 
 // short conditional jump (+-127 bytes) if register is zero
 // the destination is set by gen_fill_branch() later
-static Bit64u gen_create_branch_on_zero(HostReg reg, bool dword) {
-    if (!dword) cache_addb(0x66);
-    cache_addb(0x85); // test reg, reg
-    cache_addb(0xc0 + (reg & 7) + ((reg & 7) << 3));
-    if (reg >= 8) cache_addb(0x41);
-    cache_addw(0x0074); // jz
-    return ((Bit64u)cache.pos - 1);
+static Bit64u gen_create_branch_on_zero(HostReg reg,bool dword) {
+	gen_regcache_writeback();
+
+	if (!dword) cache_addb(0x66);
+	cache_addb(0x0b);					// or reg,reg
+	cache_addb(0xc0+reg+(reg<<3));
+
+	cache_addw(0x0074);		// jz addr
+	return ((Bit64u)cache.pos-1);
 }
 
 // short conditional jump (+-127 bytes) if register is nonzero
 // the destination is set by gen_fill_branch() later
-static Bit64u gen_create_branch_on_nonzero(HostReg reg, bool dword) {
-    if (!dword) cache_addb(0x66);
-    cache_addb(0x85); // test reg, reg
-    cache_addb(0xc0 + (reg & 7) + ((reg & 7) << 3));
-    if (reg >= 8) cache_addb(0x41);
-    cache_addw(0x0075); // jnz
-    return ((Bit64u)cache.pos - 1);
+static Bit64u gen_create_branch_on_nonzero(HostReg reg,bool dword) {
+	gen_regcache_writeback();
+
+	if (!dword) cache_addb(0x66);
+	cache_addb(0x0b);					// or reg,reg
+	cache_addb(0xc0+reg+(reg<<3));
+
+	cache_addw(0x0075);		// jnz addr
+	return ((Bit64u)cache.pos-1);
 }
 
 // calculate relative offset and fill it into the location pointed to by data
@@ -541,6 +655,8 @@ static void gen_fill_branch(DRC_PTR_SIZE_IM data) {
 	if (len<0) len=-len;
 	if (len>126) LOG_MSG("Big jump %d",len);
 #endif
+	// the branch was taken with all registers stored back
+	gen_regcache_flush();
 	*(Bit8u*)data=(Bit8u)((Bit64u)cache.pos-data-1);
 }
 
@@ -553,8 +669,18 @@ static Bit64u gen_create_branch_long_nonzero(HostReg reg,bool isdword) {
 	cache_addb(0x0a+(isdword?1:0));				// or reg,reg
 	cache_addb(0xc0+reg+(reg<<3));
 
-	cache_addw(0x850f);		// jnz
+	if (!regcache_is_dirty()) {
+		cache_addw(0x850f);		// jnz
+		cache_addd(0);
+		return ((Bit64u)cache.pos-4);
+	}
+	// store the changed registers only if the branch is taken
+	cache_addw(0x0074);			// jz skip
+	Bit8u * skip=cache.pos-1;
+	gen_regcache_writeback(false);
+	cache_addb(0xe9);			// jmp
 	cache_addd(0);
+	*skip=(Bit8u)(cache.pos-skip-1);
 	return ((Bit64u)cache.pos-4);
 }
 
@@ -563,25 +689,50 @@ static Bit64u gen_create_branch_long_leqzero(HostReg reg) {
 	cache_addw(0xf883+(reg<<8));
 	cache_addb(0x00);		// cmp reg,0
 
-	cache_addw(0x8e0f);		// jle
+	if (!regcache_is_dirty()) {
+		cache_addw(0x8e0f);		// jle
+		cache_addd(0);
+		return ((Bit64u)cache.pos-4);
+	}
+	// store the changed registers only if the branch is taken
+	cache_addw(0x007f);			// jg skip
+	Bit8u * skip=cache.pos-1;
+	gen_regcache_writeback(false);
+	cache_addb(0xe9);			// jmp
 	cache_addd(0);
+	*skip=(Bit8u)(cache.pos-skip-1);
 	return ((Bit64u)cache.pos-4);
 }
 
 // calculate long relative offset and fill it into the location pointed to by data
 static void gen_fill_branch_long(Bit64u data) {
+	gen_regcache_flush();
 	*(Bit32u*)data=(Bit32u)((Bit64u)cache.pos-data-4);
 }
 
 
 static void gen_run_code(void) {
 	cache_addb(0x53);					// push rbx
+	cache_addb(0x55);					// push rbp
+	cache_addw(0x5441);					// push r12
+	cache_addw(0x5541);					// push r13
+	cache_addw(0x5641);					// push r14
+	cache_addw(0x5741);					// push r15
+	cache_addd(0x08ec8348);				// sub  rsp,8 (keep the blocks' stack alignment)
+	gen_mov_reg_qword(FC_REGS_ADDR,(Bit64u)&cpu_regs);
 	cache_addw(0xd0ff+(FC_OP1<<8));		// call rdi
+	cache_addd(0x08c48348);				// add  rsp,8
+	cache_addw(0x5f41);					// pop  r15
+	cache_addw(0x5e41);					// pop  r14
+	cache_addw(0x5d41);					// pop  r13
+	cache_addw(0x5c41);					// pop  r12
+	cache_addb(0x5d);					// pop  rbp
 	cache_addb(0x5b);					// pop  rbx
 }
 
 // return from a function
 static void gen_return_function(void) {
+	gen_regcache_flush();
 	cache_addb(0xc3);		// ret
 }
 
@@ -590,96 +741,273 @@ static void gen_return_function(void) {
 // call to a simpler function
 // check gen_call_function_raw and gen_call_function_setup
 // for the targeted code
-static void gen_fill_function_ptr(Bit8u* pos, void* fct_ptr, Bitu flags_type) {
+static void gen_fill_function_ptr(Bit8u * pos,void* fct_ptr,Bitu flags_type) {
+	// the function pointer is replaced by code or a different pointer
+	cache_delreloc(pos+6);
 #ifdef DRC_FLAGS_INVALIDATION_DCODE
-    switch (flags_type) {
-        case t_ADDb:
-        case t_ADDw:
-        case t_ADDd:
-            *(Bit32u*)(pos + 0) = 0xc0018d8d; // lea eax, [rdi+rsi]; ret
-            *(Bit8u*)(pos + 4) = 0xc3;
-            break;
-        case t_ORb:
-        case t_ORw:
-        case t_ORd:
-            *(Bit32u*)(pos + 0) = 0xf009f889; // mov eax, edi; or eax, esi
-            *(Bit8u*)(pos + 4) = 0xc3;
-            break;
-        case t_ANDb:
-        case t_ANDw:
-        case t_ANDd:
-            *(Bit32u*)(pos + 0) = 0xf021f889; // mov eax, edi; and eax, esi
-            *(Bit8u*)(pos + 4) = 0xc3;
-            break;
-        case t_SUBb:
-        case t_SUBw:
-        case t_SUBd:
-            *(Bit32u*)(pos + 0) = 0xf029f889; // mov eax, edi; sub eax, esi
-            *(Bit8u*)(pos + 4) = 0xc3;
-            break;
-        case t_XORb:
-        case t_XORw:
-        case t_XORd:
-            *(Bit32u*)(pos + 0) = 0xf031f889; // mov eax, edi; xor eax, esi
-            *(Bit8u*)(pos + 4) = 0xc3;
-            break;
-        case t_CMPb:
-        case t_CMPw:
-        case t_CMPd:
-        case t_TESTb:
-        case t_TESTw:
-        case t_TESTd:
-            *(Bit32u*)(pos + 0) = 0x000000c3; // ret
-            break;
-        case t_INCb:
-        case t_INCw:
-        case t_INCd:
-            *(Bit32u*)(pos + 0) = 0xc0fff889; // mov eax, edi; inc eax
-            *(Bit8u*)(pos + 4) = 0xc3;
-            break;
-        case t_DECb:
-        case t_DECw:
-        case t_DECd:
-            *(Bit32u*)(pos + 0) = 0xc8fff889; // mov eax, edi; dec eax
-            *(Bit8u*)(pos + 4) = 0xc3;
-            break;
-        case t_NEGb:
-        case t_NEGw:
-        case t_NEGd:
-            *(Bit32u*)(pos + 0) = 0xd8f7f889; // mov eax, edi; neg eax
-            *(Bit8u*)(pos + 4) = 0xc3;
-            break;
-        case t_SHLb:
-        case t_SHLw:
-        case t_SHLd:
-            *(Bit32u*)(pos + 0) = 0xe1d389f8; // mov eax, edi; shl eax, cl
-            *(Bit8u*)(pos + 4) = 0xc3;
-            break;
-        case t_SHRb:
-        case t_SHRw:
-        case t_SHRd:
-            *(Bit32u*)(pos + 0) = 0xe9d389f8; // mov eax, edi; shr eax, cl
-            *(Bit8u*)(pos + 4) = 0xc3;
-            break;
-        default:
-            *(Bit64u*)(pos + 6) = (Bit64u)fct_ptr; // Fallback to function pointer
-            break;
-    }
+	// try to avoid function calls but rather directly fill in code,
+	// the 20 bytes of gen_call_function_raw are skipped after the
+	// replacement (the parameters are in edi/esi, the result in eax)
+	switch (flags_type) {
+		case t_ADDb:
+		case t_ADDw:
+		case t_ADDd:
+			*(Bit32u*)(pos+0)=0xf001f889;	// mov eax,edi; add eax,esi
+			*(Bit32u*)(pos+4)=0x90900eeb;	// skip
+			*(Bit32u*)(pos+8)=0x90909090;
+			*(Bit32u*)(pos+12)=0x90909090;
+			*(Bit32u*)(pos+16)=0x90909090;
+			break;
+		case t_ORb:
+		case t_ORw:
+		case t_ORd:
+			*(Bit32u*)(pos+0)=0xf009f889;	// mov eax,edi; or eax,esi
+			*(Bit32u*)(pos+4)=0x90900eeb;	// skip
+			*(Bit32u*)(pos+8)=0x90909090;
+			*(Bit32u*)(pos+12)=0x90909090;
+			*(Bit32u*)(pos+16)=0x90909090;
+			break;
+		case t_ANDb:
+		case t_ANDw:
+		case t_ANDd:
+			*(Bit32u*)(pos+0)=0xf021f889;	// mov eax,edi; and eax,esi
+			*(Bit32u*)(pos+4)=0x90900eeb;	// skip
+			*(Bit32u*)(pos+8)=0x90909090;
+			*(Bit32u*)(pos+12)=0x90909090;
+			*(Bit32u*)(pos+16)=0x90909090;
+			break;
+		case t_SUBb:
+		case t_SUBw:
+		case t_SUBd:
+			*(Bit32u*)(pos+0)=0xf029f889;	// mov eax,edi; sub eax,esi
+			*(Bit32u*)(pos+4)=0x90900eeb;	// skip
+			*(Bit32u*)(pos+8)=0x90909090;
+			*(Bit32u*)(pos+12)=0x90909090;
+			*(Bit32u*)(pos+16)=0x90909090;
+			break;
+		case t_XORb:
+		case t_XORw:
+		case t_XORd:
+			*(Bit32u*)(pos+0)=0xf031f889;	// mov eax,edi; xor eax,esi
+			*(Bit32u*)(pos+4)=0x90900eeb;	// skip
+			*(Bit32u*)(pos+8)=0x90909090;
+			*(Bit32u*)(pos+12)=0x90909090;
+			*(Bit32u*)(pos+16)=0x90909090;
+			break;
+		case t_CMPb:
+		case t_CMPw:
+		case t_CMPd:
+		case t_TESTb:
+		case t_TESTw:
+		case t_TESTd:
+			*(Bit32u*)(pos+0)=0x909012eb;	// skip
+			*(Bit32u*)(pos+4)=0x90909090;
+			*(Bit32u*)(pos+8)=0x90909090;
+			*(Bit32u*)(pos+12)=0x90909090;
+			*(Bit32u*)(pos+16)=0x90909090;
+			break;
+		case t_INCb:
+		case t_INCw:
+		case t_INCd:
+			*(Bit32u*)(pos+0)=0xc0fff889;	// mov eax,edi; inc eax
+			*(Bit32u*)(pos+4)=0x90900eeb;	// skip
+			*(Bit32u*)(pos+8)=0x90909090;
+			*(Bit32u*)(pos+12)=0x90909090;
+			*(Bit32u*)(pos+16)=0x90909090;
+			break;
+		case t_DECb:
+		case t_DECw:
+		case t_DECd:
+			*(Bit32u*)(pos+0)=0xc8fff889;	// mov eax,edi; dec eax
+			*(Bit32u*)(pos+4)=0x90900eeb;	// skip
+			*(Bit32u*)(pos+8)=0x90909090;
+			*(Bit32u*)(pos+12)=0x90909090;
+			*(Bit32u*)(pos+16)=0x90909090;
+			break;
+		case t_NEGb:
+		case t_NEGw:
+		case t_NEGd:
+			*(Bit32u*)(pos+0)=0xd8f7f889;	// mov eax,edi; neg eax
+			*(Bit32u*)(pos+4)=0x90900eeb;	// skip
+			*(Bit32u*)(pos+8)=0x90909090;
+			*(Bit32u*)(pos+12)=0x90909090;
+			*(Bit32u*)(pos+16)=0x90909090;
+			break;
+		default:
+			*(Bit64u*)(pos+6)=(Bit64u)fct_ptr;		// fill function pointer
+			cache_addreloc(pos+6,RELOC_ABS64,fct_ptr);
+			break;
+	}
 #else
-    *(Bit64u*)(pos + 6) = (Bit64u)fct_ptr;
+	*(Bit64u*)(pos+6)=(Bit64u)fct_ptr;		// fill function pointer
+	cache_addreloc(pos+6,RELOC_ABS64,fct_ptr);
 #endif
 }
 #endif
 
-static void cache_block_closing(Bit8u* block_start, Bitu block_size) {
-    // Simple peephole optimization: combine mov+add to lea
-    for (Bitu i = 0; i < block_size - 5; ++i) {
-        if (block_start[i] == 0x8b && block_start[i + 3] == 0x03) { // mov reg, [mem]; add reg, [mem]
-            block_start[i] = 0x8d; // lea reg, [mem+mem]
-            block_start[i + 3] = 0x04;
-            block_start[i + 4] = 0x00; // Adjust offset
-        }
-    }
+// write the address target into the generated code at pos in the way noted
+// by cache_addreloc, fails if the encoding can't reach the address
+static bool gen_fill_reloc(Bit8u * pos,Bitu type,Bit8u * target) {
+	Bit64s diff;
+	switch (type) {
+		case RELOC_ABS64:
+			*(Bit64u*)pos=(Bit64u)target;
+			return true;
+		case RELOC_ABS32:
+			if ((Bit64u)target>=0x100000000LL) return false;
+			*(Bit32u*)pos=(Bit32u)(Bit64u)target;
+			return true;
+		case RELOC_REGS8:
+			diff=target-(Bit8u*)&cpu_regs;
+			if (diff<-128 || diff>127) return false;
+			*pos=(Bit8u)diff;
+			return true;
+		case RELOC_REGS32:
+			diff=target-(Bit8u*)&cpu_regs;
+			break;
+		default:
+			// RIP-relative, type-RELOC_RIP32 more bytes up to the end of the instruction
+			diff=target-(pos+4+(type-RELOC_RIP32));
+			break;
+	}
+	if ((diff>>63)!=(diff>>31)) return false;
+	*(Bit32u*)pos=(Bit32u)(((Bit64u)diff)&0xffffffffLL);
+	return true;
+}
+
+static void cache_block_closing(Bit8u* block_start,Bitu block_size) { }
+
+static void cache_block_before_close(void) {
+	// every block starts without cached registers
+	gen_regcache_clear();
 }
 
-static void cache_block_before_close(void) { }
+
+#ifdef DRC_USE_REGS_ADDR
+
+// the functions below access cpu_regs[index] through the register cache,
+// index is the byte offset into cpu_regs; parts of a register that cannot
+// be addressed in r12-r15 are accessed in memory after storing the register
+
+// mov 16bit value from cpu_regs[index] into dest_reg (index modulo 2 must be zero)
+static void gen_mov_regval16_to_reg(HostReg dest_reg,Bitu index) {
+	if (index & 3) {
+		gen_regcache_drop(index>>2);
+		cache_addw(0xb70f);				// movzx dest_reg,word [FC_REGS_ADDR+index]
+		cache_addb(0x40+(dest_reg<<3)+FC_REGS_ADDR);
+		cache_addb(index);
+		return;
+	}
+	Bitu slot=gen_regcache_get(index>>2,true);
+	cache_addb(0x41);
+	cache_addw(0xb70f);					// movzx dest_reg,r12w-r15w
+	cache_addb(0xc0+(dest_reg<<3)+REGCACHE_HOSTREG(slot));
+}
+
+// mov 32bit value from cpu_regs[index] into dest_reg (index modulo 4 must be zero)
+static void gen_mov_regval32_to_reg(HostReg dest_reg,Bitu index) {
+	Bitu slot=gen_regcache_get(index>>2,true);
+	cache_addb(0x41);
+	cache_addb(0x8b);					// mov dest_reg,r12d-r15d
+	cache_addb(0xc0+(dest_reg<<3)+REGCACHE_HOSTREG(slot));
+}
+
+// move a 32bit (dword==true) or 16bit (dword==false) value from cpu_regs[index] into dest_reg (if dword==true index modulo 4 must be zero) (if dword==false index modulo 2 must be zero)
+// 16bit moves may destroy the upper 16bit of the destination register
+static void gen_mov_regword_to_reg(HostReg dest_reg,Bitu index,bool dword) {
+	if (dword) gen_mov_regval32_to_reg(dest_reg,index);
+	else gen_mov_regval16_to_reg(dest_reg,index);
+}
+
+// move an 8bit value from cpu_regs[index] into dest_reg
+// the upper 24bit of the destination register can be destroyed
+// this function does not use FC_OP1/FC_OP2 as dest_reg as these
+// registers might not be directly byte-accessible on some architectures
+static void gen_mov_regbyte_to_reg_low(HostReg dest_reg,Bitu index) {
+	if (index & 2) {
+		gen_regcache_drop(index>>2);
+		cache_addw(0xb60f);				// movzx dest_reg,byte [FC_REGS_ADDR+index]
+		cache_addb(0x40+(dest_reg<<3)+FC_REGS_ADDR);
+		cache_addb(index);
+		return;
+	}
+	Bitu slot=gen_regcache_get(index>>2,true);
+	cache_addb(0x41);
+	if (index & 1) {
+		cache_addw(0xb70f);				// movzx dest_reg,r12w-r15w
+		cache_addb(0xc0+(dest_reg<<3)+REGCACHE_HOSTREG(slot));
+		cache_addw(0xe8c1+(dest_reg<<8));
+		cache_addb(0x08);				// shr dest_reg,8
+	} else {
+		cache_addw(0xb60f);				// movzx dest_reg,r12b-r15b
+		cache_addb(0xc0+(dest_reg<<3)+REGCACHE_HOSTREG(slot));
+	}
+}
+
+// move an 8bit value from cpu_regs[index] into dest_reg
+// the upper 24bit of the destination register can be destroyed
+// this function can use FC_OP1/FC_OP2 as dest_reg which are
+// not directly byte-accessible on some architectures
+static void gen_mov_regbyte_to_reg_low_canuseword(HostReg dest_reg,Bitu index) {
+	gen_mov_regbyte_to_reg_low(dest_reg,index);
+}
+
+// add a 32bit value from cpu_regs[index] to a full register (index modulo 4 must be zero)
+static void gen_add_regval32_to_reg(HostReg reg,Bitu index) {
+	Bitu slot=gen_regcache_get(index>>2,true);
+	cache_addb(0x41);
+	cache_addb(0x03);					// add reg,r12d-r15d
+	cache_addb(0xc0+(reg<<3)+REGCACHE_HOSTREG(slot));
+}
+
+// move 16bit of register into cpu_regs[index] (index modulo 2 must be zero)
+static void gen_mov_regval16_from_reg(HostReg src_reg,Bitu index) {
+	if (!(index & 3)) {
+		Bitu slot=gen_regcache_get(index>>2,true);
+		cache_addb(0x66);
+		cache_addb(0x41);
+		cache_addb(0x89);				// mov r12w-r15w,src_reg
+		cache_addb(0xc0+(src_reg<<3)+REGCACHE_HOSTREG(slot));
+		regcache.dirty[slot]=true;
+		return;
+	}
+	gen_regcache_drop(index>>2);
+	cache_addb(0x66);
+	cache_addb(0x89);					// mov word [FC_REGS_ADDR+index],src_reg
+	cache_addb(0x40+(src_reg<<3)+FC_REGS_ADDR);
+	cache_addb(index);
+}
+
+// move 32bit of register into cpu_regs[index] (index modulo 4 must be zero)
+static void gen_mov_regval32_from_reg(HostReg src_reg,Bitu index) {
+	Bitu slot=gen_regcache_get(index>>2,false);
+	cache_addb(0x41);
+	cache_addb(0x89);					// mov r12d-r15d,src_reg
+	cache_addb(0xc0+(src_reg<<3)+REGCACHE_HOSTREG(slot));
+	regcache.dirty[slot]=true;
+}
+
+// move 32bit (dword==true) or 16bit (dword==false) of a register into cpu_regs[index] (if dword==true index modulo 4 must be zero) (if dword==false index modulo 2 must be zero)
+static void gen_mov_regword_from_reg(HostReg src_reg,Bitu index,bool dword) {
+	if (dword) gen_mov_regval32_from_reg(src_reg,index);
+	else gen_mov_regval16_from_reg(src_reg,index);
+}
+
+// move the lowest 8bit of a register into cpu_regs[index]
+static void gen_mov_regbyte_from_reg_low(HostReg src_reg,Bitu index) {
+	if (!(index & 3)) {
+		Bitu slot=gen_regcache_get(index>>2,true);
+		cache_addb(0x41);
+		cache_addb(0x88);				// mov r12b-r15b,src_reg
+		cache_addb(0xc0+(src_reg<<3)+REGCACHE_HOSTREG(slot));
+		regcache.dirty[slot]=true;
+		return;
+	}
+	gen_regcache_drop(index>>2);
+	cache_addb(0x40);
+	cache_addb(0x88);					// mov byte [FC_REGS_ADDR+index],src_reg
+	cache_addb(0x40+(src_reg<<3)+FC_REGS_ADDR);
+	cache_addb(index);
+}
+
+#endif
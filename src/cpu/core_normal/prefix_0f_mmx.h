@@ -148,6 +148,9 @@
 			GetEAa;
 			src.q=LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_sll_epi16(MMX_Load(dest),MMX_Load(&src)));
+#else
 		if (src.q > 15) dest->q = 0;
 		else {
 			dest->uw.w0 <<= src.ub.b0;
@@ -155,6 +158,7 @@
 			dest->uw.w2 <<= src.ub.b0;
 			dest->uw.w3 <<= src.ub.b0;
 		}
+#endif
 		break;
 	}
 	CASE_0F_D(0xd1)												/* PSRLW Pq,Qq */
@@ -168,6 +172,9 @@
 			GetEAa;
 			src.q=LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_srl_epi16(MMX_Load(dest),MMX_Load(&src)));
+#else
 		if (src.q > 15) dest->q = 0;
 		else {
 			dest->uw.w0 >>= src.ub.b0;
@@ -175,6 +182,7 @@
 			dest->uw.w2 >>= src.ub.b0;
 			dest->uw.w3 >>= src.ub.b0;
 		}
+#endif
 		break;
 	}
 	CASE_0F_D(0xe1)												/* PSRAW Pq,Qq */
@@ -182,14 +190,17 @@
 		GetRM;
 		MMX_reg* dest=lookupRMregMM[rm];
 		MMX_reg src;
-		MMX_reg tmp;
-		tmp.q = dest->q;
 		if (rm>=0xc0) {
 			src.q=reg_mmx[rm&7].q;
 		} else {
 			GetEAa;
 			src.q=LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_sra_epi16(MMX_Load(dest),MMX_Load(&src)));
+#else
+		MMX_reg tmp;
+		tmp.q = dest->q;
 		if (!src.q) break;
 		if (src.q > 15) {
 			dest->uw.w0 = (tmp.uw.w0&0x8000)?0xffff:0;
@@ -206,6 +217,7 @@
 			if (tmp.uw.w2&0x8000) dest->uw.w2 |= (0xffff << (16 - src.ub.b0));
 			if (tmp.uw.w3&0x8000) dest->uw.w3 |= (0xffff << (16 - src.ub.b0));
 		}
+#endif
 		break;
 	}
 	CASE_0F_D(0x71)												/* PSLLW/PSRLW/PSRAW Pq,Ib */
@@ -214,6 +226,20 @@
 		Bit8u op=(rm>>3)&7;
 		Bit8u shift=Fetchb();
 		MMX_reg* dest=&reg_mmx[rm&7];
+#if MMX_SSE2
+		__m128i count=_mm_cvtsi32_si128(shift);
+		switch (op) {
+			case 0x06: 	/*PSLL*/
+				MMX_Store(dest,_mm_sll_epi16(MMX_Load(dest),count));
+				break;
+			case 0x02:  /*PSRL*/
+				MMX_Store(dest,_mm_srl_epi16(MMX_Load(dest),count));
+				break;
+			case 0x04:  /*PSRA*/
+				MMX_Store(dest,_mm_sra_epi16(MMX_Load(dest),count));
+				break;
+		}
+#else
 		switch (op) {
 			case 0x06: 	/*PSLLW*/
 				if (shift > 15) dest->q = 0;
@@ -254,6 +280,7 @@
 				}
 				break;
 		}
+#endif
 		break;
 	}
 	CASE_0F_D(0xf2)												/* PSLLD Pq,Qq */
@@ -267,11 +294,15 @@
 			GetEAa;
 			src.q=LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_sll_epi32(MMX_Load(dest),MMX_Load(&src)));
+#else
 		if (src.q > 31) dest->q = 0;
 		else {
 			dest->ud.d0 <<= src.ub.b0;
 			dest->ud.d1 <<= src.ub.b0;
 		}
+#endif
 		break;
 	}
 	CASE_0F_D(0xd2)												/* PSRLD Pq,Qq */
@@ -285,11 +316,15 @@
 			GetEAa;
 			src.q=LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_srl_epi32(MMX_Load(dest),MMX_Load(&src)));
+#else
 		if (src.q > 31) dest->q = 0;
 		else {
 			dest->ud.d0 >>= src.ub.b0;
 			dest->ud.d1 >>= src.ub.b0;
 		}
+#endif
 		break;
 	}
 	CASE_0F_D(0xe2)												/* PSRAD Pq,Qq */
@@ -297,14 +332,17 @@
 		GetRM;
 		MMX_reg* dest=lookupRMregMM[rm];
 		MMX_reg src;
-		MMX_reg tmp;
-		tmp.q = dest->q;
 		if (rm>=0xc0) {
 			src.q=reg_mmx[rm&7].q;
 		} else {
 			GetEAa;
 			src.q=LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_sra_epi32(MMX_Load(dest),MMX_Load(&src)));
+#else
+		MMX_reg tmp;
+		tmp.q = dest->q;
 		if (!src.q) break;
 		if (src.q > 31) {
 			dest->ud.d0 = (tmp.ud.d0&0x80000000)?0xffffffff:0;
@@ -315,6 +353,7 @@
 			if (tmp.ud.d0&0x80000000) dest->ud.d0 |= (0xffffffff << (32 - src.ub.b0));
 			if (tmp.ud.d1&0x80000000) dest->ud.d1 |= (0xffffffff << (32 - src.ub.b0));
 		}
+#endif
 		break;
 	}
 	CASE_0F_D(0x72)												/* PSLLD/PSRLD/PSRAD Pq,Ib */
@@ -323,6 +362,20 @@
 		Bit8u op=(rm>>3)&7;
 		Bit8u shift=Fetchb();
 		MMX_reg* dest=&reg_mmx[rm&7];
+#if MMX_SSE2
+		__m128i count=_mm_cvtsi32_si128(shift);
+		switch (op) {
+			case 0x06: 	/*PSLL*/
+				MMX_Store(dest,_mm_sll_epi32(MMX_Load(dest),count));
+				break;
+			case 0x02:  /*PSRL*/
+				MMX_Store(dest,_mm_srl_epi32(MMX_Load(dest),count));
+				break;
+			case 0x04:  /*PSRA*/
+				MMX_Store(dest,_mm_sra_epi32(MMX_Load(dest),count));
+				break;
+		}
+#else
 		switch (op) {
 			case 0x06: 	/*PSLLD*/
 				if (shift > 31) dest->q = 0;
@@ -353,6 +406,7 @@
 				}
 				break;
 		}
+#endif
 		break;
 	}
 
@@ -367,8 +421,12 @@
 			GetEAa;
 			src.q=LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_sll_epi64(MMX_Load(dest),MMX_Load(&src)));
+#else
 		if (src.q > 63) dest->q = 0;
 		else dest->q <<= src.ub.b0;
+#endif
 		break;
 	}
 	CASE_0F_D(0xd3)												/* PSRLQ Pq,Qq */
@@ -382,8 +440,12 @@
 			GetEAa;
 			src.q=LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_srl_epi64(MMX_Load(dest),MMX_Load(&src)));
+#else
 		if (src.q > 63) dest->q = 0;
 		else dest->q >>= src.ub.b0;
+#endif
 		break;
 	}
 	CASE_0F_D(0x73)												/* PSLLQ/PSRLQ Pq,Ib */
@@ -415,6 +477,9 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_add_epi8(MMX_Load(dest),MMX_Load(&src)));
+#else
 		dest->ub.b0 += src.ub.b0;
 		dest->ub.b1 += src.ub.b1;
 		dest->ub.b2 += src.ub.b2;
@@ -423,6 +488,7 @@
 		dest->ub.b5 += src.ub.b5;
 		dest->ub.b6 += src.ub.b6;
 		dest->ub.b7 += src.ub.b7;
+#endif
 		break;
 	}
 	CASE_0F_D(0xFD)												/* PADDW Pq,Qq */
@@ -436,10 +502,14 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_add_epi16(MMX_Load(dest),MMX_Load(&src)));
+#else
 		dest->uw.w0 += src.uw.w0;
 		dest->uw.w1 += src.uw.w1;
 		dest->uw.w2 += src.uw.w2;
 		dest->uw.w3 += src.uw.w3;
+#endif
 		break;
 	}
 	CASE_0F_D(0xFE)												/* PADDD Pq,Qq */
@@ -453,8 +523,12 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_add_epi32(MMX_Load(dest),MMX_Load(&src)));
+#else
 		dest->ud.d0 += src.ud.d0;
 		dest->ud.d1 += src.ud.d1;
+#endif
 		break;
 	}
 	CASE_0F_D(0xEC)												/* PADDSB Pq,Qq */
@@ -468,6 +542,9 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_adds_epi8(MMX_Load(dest),MMX_Load(&src)));
+#else
 		dest->sb.b0 = SaturateWordSToByteS((Bit16s)dest->sb.b0+(Bit16s)src.sb.b0);
 		dest->sb.b1 = SaturateWordSToByteS((Bit16s)dest->sb.b1+(Bit16s)src.sb.b1);
 		dest->sb.b2 = SaturateWordSToByteS((Bit16s)dest->sb.b2+(Bit16s)src.sb.b2);
@@ -476,6 +553,7 @@
 		dest->sb.b5 = SaturateWordSToByteS((Bit16s)dest->sb.b5+(Bit16s)src.sb.b5);
 		dest->sb.b6 = SaturateWordSToByteS((Bit16s)dest->sb.b6+(Bit16s)src.sb.b6);
 		dest->sb.b7 = SaturateWordSToByteS((Bit16s)dest->sb.b7+(Bit16s)src.sb.b7);
+#endif
 		break;
 	}
 	CASE_0F_D(0xED)												/* PADDSW Pq,Qq */
@@ -489,10 +567,14 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_adds_epi16(MMX_Load(dest),MMX_Load(&src)));
+#else
 		dest->sw.w0 = SaturateDwordSToWordS((Bit32s)dest->sw.w0+(Bit32s)src.sw.w0);
 		dest->sw.w1 = SaturateDwordSToWordS((Bit32s)dest->sw.w1+(Bit32s)src.sw.w1);
 		dest->sw.w2 = SaturateDwordSToWordS((Bit32s)dest->sw.w2+(Bit32s)src.sw.w2);
 		dest->sw.w3 = SaturateDwordSToWordS((Bit32s)dest->sw.w3+(Bit32s)src.sw.w3);
+#endif
 		break;
 	}
 	CASE_0F_D(0xDC)												/* PADDUSB Pq,Qq */
@@ -506,6 +588,9 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_adds_epu8(MMX_Load(dest),MMX_Load(&src)));
+#else
 		dest->ub.b0 = SaturateWordSToByteU((Bit16s)dest->ub.b0+(Bit16s)src.ub.b0);
 		dest->ub.b1 = SaturateWordSToByteU((Bit16s)dest->ub.b1+(Bit16s)src.ub.b1);
 		dest->ub.b2 = SaturateWordSToByteU((Bit16s)dest->ub.b2+(Bit16s)src.ub.b2);
@@ -514,6 +599,7 @@
 		dest->ub.b5 = SaturateWordSToByteU((Bit16s)dest->ub.b5+(Bit16s)src.ub.b5);
 		dest->ub.b6 = SaturateWordSToByteU((Bit16s)dest->ub.b6+(Bit16s)src.ub.b6);
 		dest->ub.b7 = SaturateWordSToByteU((Bit16s)dest->ub.b7+(Bit16s)src.ub.b7);
+#endif
 		break;
 	}
 	CASE_0F_D(0xDD)												/* PADDUSW Pq,Qq */
@@ -527,10 +613,14 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_adds_epu16(MMX_Load(dest),MMX_Load(&src)));
+#else
 		dest->uw.w0 = SaturateDwordSToWordU((Bit32s)dest->uw.w0+(Bit32s)src.uw.w0);
 		dest->uw.w1 = SaturateDwordSToWordU((Bit32s)dest->uw.w1+(Bit32s)src.uw.w1);
 		dest->uw.w2 = SaturateDwordSToWordU((Bit32s)dest->uw.w2+(Bit32s)src.uw.w2);
 		dest->uw.w3 = SaturateDwordSToWordU((Bit32s)dest->uw.w3+(Bit32s)src.uw.w3);
+#endif
 		break;
 	}
 	CASE_0F_D(0xF8)												/* PSUBB Pq,Qq */
@@ -544,6 +634,9 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_sub_epi8(MMX_Load(dest),MMX_Load(&src)));
+#else
 		dest->ub.b0 -= src.ub.b0;
 		dest->ub.b1 -= src.ub.b1;
 		dest->ub.b2 -= src.ub.b2;
@@ -552,6 +645,7 @@
 		dest->ub.b5 -= src.ub.b5;
 		dest->ub.b6 -= src.ub.b6;
 		dest->ub.b7 -= src.ub.b7;
+#endif
 		break;
 	}
 	CASE_0F_D(0xF9)												/* PSUBW Pq,Qq */
@@ -565,10 +659,14 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_sub_epi16(MMX_Load(dest),MMX_Load(&src)));
+#else
 		dest->uw.w0 -= src.uw.w0;
 		dest->uw.w1 -= src.uw.w1;
 		dest->uw.w2 -= src.uw.w2;
 		dest->uw.w3 -= src.uw.w3;
+#endif
 		break;
 	}
 	CASE_0F_D(0xFA)												/* PSUBD Pq,Qq */
@@ -582,8 +680,12 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_sub_epi32(MMX_Load(dest),MMX_Load(&src)));
+#else
 		dest->ud.d0 -= src.ud.d0;
 		dest->ud.d1 -= src.ud.d1;
+#endif
 		break;
 	}
 	CASE_0F_D(0xE8)												/* PSUBSB Pq,Qq */
@@ -597,6 +699,9 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_subs_epi8(MMX_Load(dest),MMX_Load(&src)));
+#else
 		dest->sb.b0 = SaturateWordSToByteS((Bit16s)dest->sb.b0-(Bit16s)src.sb.b0);
 		dest->sb.b1 = SaturateWordSToByteS((Bit16s)dest->sb.b1-(Bit16s)src.sb.b1);
 		dest->sb.b2 = SaturateWordSToByteS((Bit16s)dest->sb.b2-(Bit16s)src.sb.b2);
@@ -605,6 +710,7 @@
 		dest->sb.b5 = SaturateWordSToByteS((Bit16s)dest->sb.b5-(Bit16s)src.sb.b5);
 		dest->sb.b6 = SaturateWordSToByteS((Bit16s)dest->sb.b6-(Bit16s)src.sb.b6);
 		dest->sb.b7 = SaturateWordSToByteS((Bit16s)dest->sb.b7-(Bit16s)src.sb.b7);
+#endif
 		break;
 	}
 	CASE_0F_D(0xE9)												/* PSUBSW Pq,Qq */
@@ -618,10 +724,14 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_subs_epi16(MMX_Load(dest),MMX_Load(&src)));
+#else
 		dest->sw.w0 = SaturateDwordSToWordS((Bit32s)dest->sw.w0-(Bit32s)src.sw.w0);
 		dest->sw.w1 = SaturateDwordSToWordS((Bit32s)dest->sw.w1-(Bit32s)src.sw.w1);
 		dest->sw.w2 = SaturateDwordSToWordS((Bit32s)dest->sw.w2-(Bit32s)src.sw.w2);
 		dest->sw.w3 = SaturateDwordSToWordS((Bit32s)dest->sw.w3-(Bit32s)src.sw.w3);
+#endif
 		break;
 	}
 	CASE_0F_D(0xD8)												/* PSUBUSB Pq,Qq */
@@ -636,6 +746,9 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_subs_epu8(MMX_Load(dest),MMX_Load(&src)));
+#else
 		result.q = 0;
 		if (dest->ub.b0>src.ub.b0) result.ub.b0 = dest->ub.b0 - src.ub.b0;
 		if (dest->ub.b1>src.ub.b1) result.ub.b1 = dest->ub.b1 - src.ub.b1;
@@ -646,6 +759,7 @@
 		if (dest->ub.b6>src.ub.b6) result.ub.b6 = dest->ub.b6 - src.ub.b6;
 		if (dest->ub.b7>src.ub.b7) result.ub.b7 = dest->ub.b7 - src.ub.b7;
 		dest->q = result.q;
+#endif
 		break;
 	}
 
@@ -661,12 +775,16 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_subs_epu16(MMX_Load(dest),MMX_Load(&src)));
+#else
 		result.q = 0;
 		if (dest->uw.w0>src.uw.w0) result.uw.w0 = dest->uw.w0 - src.uw.w0;
 		if (dest->uw.w1>src.uw.w1) result.uw.w1 = dest->uw.w1 - src.uw.w1;
 		if (dest->uw.w2>src.uw.w2) result.uw.w2 = dest->uw.w2 - src.uw.w2;
 		if (dest->uw.w3>src.uw.w3) result.uw.w3 = dest->uw.w3 - src.uw.w3;
 		dest->q = result.q;
+#endif
 		break;
 	}
 	CASE_0F_D(0xE5)												/* PMULHW Pq,Qq */
@@ -680,6 +798,9 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_mulhi_epi16(MMX_Load(dest),MMX_Load(&src)));
+#else
 		Bit32s product0 = (Bit32s)dest->sw.w0 * (Bit32s)src.sw.w0;
 		Bit32s product1 = (Bit32s)dest->sw.w1 * (Bit32s)src.sw.w1;
 		Bit32s product2 = (Bit32s)dest->sw.w2 * (Bit32s)src.sw.w2;
@@ -688,6 +809,7 @@
 		dest->uw.w1 = (Bit16u)(product1 >> 16);
 		dest->uw.w2 = (Bit16u)(product2 >> 16);
 		dest->uw.w3 = (Bit16u)(product3 >> 16);
+#endif
 		break;
 	}
 	CASE_0F_D(0xD5)												/* PMULLW Pq,Qq */
@@ -701,6 +823,9 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_mullo_epi16(MMX_Load(dest),MMX_Load(&src)));
+#else
 		Bit32u product0 = (Bit32u)dest->uw.w0 * (Bit32u)src.uw.w0;
 		Bit32u product1 = (Bit32u)dest->uw.w1 * (Bit32u)src.uw.w1;
 		Bit32u product2 = (Bit32u)dest->uw.w2 * (Bit32u)src.uw.w2;
@@ -709,6 +834,7 @@
 		dest->uw.w1 = (product1 & 0xffff);
 		dest->uw.w2 = (product2 & 0xffff);
 		dest->uw.w3 = (product3 & 0xffff);
+#endif
 		break;
 	}
 	CASE_0F_D(0xF5)												/* PMADDWD Pq,Qq */
@@ -722,6 +848,9 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_madd_epi16(MMX_Load(dest),MMX_Load(&src)));
+#else
 		if (dest->ud.d0 == 0x80008000 && src.ud.d0 == 0x80008000)
 			dest->ud.d0 = 0x80000000;
 		else {
@@ -736,6 +865,7 @@
 			Bit32s product3 = (Bit32s)dest->sw.w3 * (Bit32s)src.sw.w3;
 			dest->sd.d1 = product2 + product3;
 		}
+#endif
 		break;
 	}
 
@@ -751,6 +881,9 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_cmpeq_epi8(MMX_Load(dest),MMX_Load(&src)));
+#else
 		dest->ub.b0 = dest->ub.b0==src.ub.b0?0xff:0;
 		dest->ub.b1 = dest->ub.b1==src.ub.b1?0xff:0;
 		dest->ub.b2 = dest->ub.b2==src.ub.b2?0xff:0;
@@ -759,6 +892,7 @@
 		dest->ub.b5 = dest->ub.b5==src.ub.b5?0xff:0;
 		dest->ub.b6 = dest->ub.b6==src.ub.b6?0xff:0;
 		dest->ub.b7 = dest->ub.b7==src.ub.b7?0xff:0;
+#endif
 		break;
 	}
 	CASE_0F_D(0x75)												/* PCMPEQW Pq,Qq */
@@ -772,10 +906,14 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_cmpeq_epi16(MMX_Load(dest),MMX_Load(&src)));
+#else
 		dest->uw.w0 = dest->uw.w0==src.uw.w0?0xffff:0;
 		dest->uw.w1 = dest->uw.w1==src.uw.w1?0xffff:0;
 		dest->uw.w2 = dest->uw.w2==src.uw.w2?0xffff:0;
 		dest->uw.w3 = dest->uw.w3==src.uw.w3?0xffff:0;
+#endif
 		break;
 	}
 	CASE_0F_D(0x76)												/* PCMPEQD Pq,Qq */
@@ -789,8 +927,12 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_cmpeq_epi32(MMX_Load(dest),MMX_Load(&src)));
+#else
 		dest->ud.d0 = dest->ud.d0==src.ud.d0?0xffffffff:0;
 		dest->ud.d1 = dest->ud.d1==src.ud.d1?0xffffffff:0;
+#endif
 		break;
 	}
 	CASE_0F_D(0x64)												/* PCMPGTB Pq,Qq */
@@ -804,6 +946,9 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_cmpgt_epi8(MMX_Load(dest),MMX_Load(&src)));
+#else
 		dest->ub.b0 = dest->sb.b0>src.sb.b0?0xff:0;
 		dest->ub.b1 = dest->sb.b1>src.sb.b1?0xff:0;
 		dest->ub.b2 = dest->sb.b2>src.sb.b2?0xff:0;
@@ -812,6 +957,7 @@
 		dest->ub.b5 = dest->sb.b5>src.sb.b5?0xff:0;
 		dest->ub.b6 = dest->sb.b6>src.sb.b6?0xff:0;
 		dest->ub.b7 = dest->sb.b7>src.sb.b7?0xff:0;
+#endif
 		break;
 	}
 	CASE_0F_D(0x65)												/* PCMPGTW Pq,Qq */
@@ -825,10 +971,14 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_cmpgt_epi16(MMX_Load(dest),MMX_Load(&src)));
+#else
 		dest->uw.w0 = dest->sw.w0>src.sw.w0?0xffff:0;
 		dest->uw.w1 = dest->sw.w1>src.sw.w1?0xffff:0;
 		dest->uw.w2 = dest->sw.w2>src.sw.w2?0xffff:0;
 		dest->uw.w3 = dest->sw.w3>src.sw.w3?0xffff:0;
+#endif
 		break;
 	}
 	CASE_0F_D(0x66)												/* PCMPGTD Pq,Qq */
@@ -842,8 +992,12 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_cmpgt_epi32(MMX_Load(dest),MMX_Load(&src)));
+#else
 		dest->ud.d0 = dest->sd.d0>src.sd.d0?0xffffffff:0;
 		dest->ud.d1 = dest->sd.d1>src.sd.d1?0xffffffff:0;
+#endif
 		break;
 	}
 
@@ -859,6 +1013,10 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		__m128i val=_mm_unpacklo_epi64(MMX_Load(dest),MMX_Load(&src));
+		MMX_Store(dest,_mm_packs_epi16(val,val));
+#else
 		dest->sb.b0 = SaturateWordSToByteS(dest->sw.w0);
 		dest->sb.b1 = SaturateWordSToByteS(dest->sw.w1);
 		dest->sb.b2 = SaturateWordSToByteS(dest->sw.w2);
@@ -867,6 +1025,7 @@
 		dest->sb.b5 = SaturateWordSToByteS(src.sw.w1);
 		dest->sb.b6 = SaturateWordSToByteS(src.sw.w2);
 		dest->sb.b7 = SaturateWordSToByteS(src.sw.w3);
+#endif
 		break;
 	}
 	CASE_0F_D(0x6B)												/* PACKSSDW Pq,Qq */
@@ -880,10 +1039,15 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		__m128i val=_mm_unpacklo_epi64(MMX_Load(dest),MMX_Load(&src));
+		MMX_Store(dest,_mm_packs_epi32(val,val));
+#else
 		dest->sw.w0 = SaturateDwordSToWordS(dest->sd.d0);
 		dest->sw.w1 = SaturateDwordSToWordS(dest->sd.d1);
 		dest->sw.w2 = SaturateDwordSToWordS(src.sd.d0);
 		dest->sw.w3 = SaturateDwordSToWordS(src.sd.d1);
+#endif
 		break;
 	}
 	CASE_0F_D(0x67)												/* PACKUSWB Pq,Qq */
@@ -897,6 +1061,10 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		__m128i val=_mm_unpacklo_epi64(MMX_Load(dest),MMX_Load(&src));
+		MMX_Store(dest,_mm_packus_epi16(val,val));
+#else
 		dest->ub.b0 = SaturateWordSToByteU(dest->sw.w0);
 		dest->ub.b1 = SaturateWordSToByteU(dest->sw.w1);
 		dest->ub.b2 = SaturateWordSToByteU(dest->sw.w2);
@@ -905,6 +1073,7 @@
 		dest->ub.b5 = SaturateWordSToByteU(src.sw.w1);
 		dest->ub.b6 = SaturateWordSToByteU(src.sw.w2);
 		dest->ub.b7 = SaturateWordSToByteU(src.sw.w3);
+#endif
 		break;
 	}
 	CASE_0F_D(0x68)												/* PUNPCKHBW Pq,Qq */
@@ -918,6 +1087,10 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		__m128i val=_mm_unpacklo_epi8(MMX_Load(dest),MMX_Load(&src));
+		MMX_Store(dest,_mm_unpackhi_epi64(val,val));
+#else
 		dest->ub.b0 = dest->ub.b4;
 		dest->ub.b1 = src.ub.b4;
 		dest->ub.b2 = dest->ub.b5;
@@ -926,6 +1099,7 @@
 		dest->ub.b5 = src.ub.b6;
 		dest->ub.b6 = dest->ub.b7;
 		dest->ub.b7 = src.ub.b7;
+#endif
 		break;
 	}
 	CASE_0F_D(0x69)												/* PUNPCKHWD Pq,Qq */
@@ -939,10 +1113,15 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		__m128i val=_mm_unpacklo_epi16(MMX_Load(dest),MMX_Load(&src));
+		MMX_Store(dest,_mm_unpackhi_epi64(val,val));
+#else
 		dest->uw.w0 = dest->uw.w2;
 		dest->uw.w1 = src.uw.w2;
 		dest->uw.w2 = dest->uw.w3;
 		dest->uw.w3 = src.uw.w3;
+#endif
 		break;
 	}
 	CASE_0F_D(0x6A)												/* PUNPCKHDQ Pq,Qq */
@@ -956,8 +1135,13 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		__m128i val=_mm_unpacklo_epi32(MMX_Load(dest),MMX_Load(&src));
+		MMX_Store(dest,_mm_unpackhi_epi64(val,val));
+#else
 		dest->ud.d0 = dest->ud.d1;
 		dest->ud.d1 = src.ud.d1;
+#endif
 		break;
 	}
 	CASE_0F_D(0x60)												/* PUNPCKLBW Pq,Qq */
@@ -971,6 +1155,9 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_unpacklo_epi8(MMX_Load(dest),MMX_Load(&src)));
+#else
 		dest->ub.b7 = src.ub.b3;
 		dest->ub.b6 = dest->ub.b3;
 		dest->ub.b5 = src.ub.b2;
@@ -979,6 +1166,7 @@
 		dest->ub.b2 = dest->ub.b1;
 		dest->ub.b1 = src.ub.b0;
 		dest->ub.b0 = dest->ub.b0;
+#endif
 		break;
 	}
 	CASE_0F_D(0x61)												/* PUNPCKLWD Pq,Qq */
@@ -992,10 +1180,14 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_unpacklo_epi16(MMX_Load(dest),MMX_Load(&src)));
+#else
 		dest->uw.w3 = src.uw.w1;
 		dest->uw.w2 = dest->uw.w1;
 		dest->uw.w1 = src.uw.w0;
 		dest->uw.w0 = dest->uw.w0;
+#endif
 		break;
 	}
 	CASE_0F_D(0x62)												/* PUNPCKLDQ Pq,Qq */
@@ -1009,6 +1201,10 @@
 			GetEAa;
 			src.q = LoadMq(eaa);
 		}
+#if MMX_SSE2
+		MMX_Store(dest,_mm_unpacklo_epi32(MMX_Load(dest),MMX_Load(&src)));
+#else
 		dest->ud.d1 = src.ud.d0;
+#endif
 		break;
 	}
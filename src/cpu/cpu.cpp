@@ -80,6 +80,7 @@ void CPU_Core_Dyn_X86_SetFPUMode(bool dh_fpu);
 #elif (C_DYNREC)
 void CPU_Core_Dynrec_Init(void);
 void CPU_Core_Dynrec_Cache_Init(bool enable_cache);
+void CPU_Core_Dynrec_Cache_File(const char * name);
 void CPU_Core_Dynrec_Cache_Close(void);
 #endif
 
@@ -1726,7 +1727,8 @@ void CPU_HLT(Bitu oldeip) {
         return;
     }
     reg_eip = oldeip;
-    // Simulate CPU_IODelay(100) with a placeholder
+    // Skip to the next PIC event, the cycles are not counted as work for auto cycles
+    CPU_IODelayRemoved += CPU_Cycles;
     CPU_Cycles = 0;
     printf("[CPU] CPU_HLT: Halted");
 }
@@ -1780,36 +1782,25 @@ void CPU_Change_Config(Section* newconfig) {
         return;
     }
 
-    // Log available properties for debugging
-    int prop_count = 0;
-    while (section->Get_prop(prop_count)) {
-        Property* prop = section->Get_prop(prop_count);
-        printf("[CPU] CPU_Change_Config: Property %d: %s", prop_count, prop->GetValue().ToString().c_str());
-        prop_count++;
-    }
-    printf("[CPU] CPU_Change_Config: Total properties found: %d", prop_count);
-
-    // Get properties with fallback to defaults if missing
-    Property* p_core = section->Get_prop(0);      // core
-    Property* p_cycles = section->Get_prop(1);    // cycles
-    Property* p_cycleup = section->Get_prop(2);   // cycleup
-    Property* p_cycledown = section->Get_prop(3); // cycledown
-    Property* p_arch = section->Get_prop(4);      // cputype
-
-    // Default values
-    std::string core = p_core ? p_core->GetValue().ToString() : "auto";
-    std::string cputype = p_arch ? p_arch->GetValue().ToString() : "auto";
-    int cycles = p_cycles ? static_cast<int>(p_cycles->GetValue()) : 3000;
-    int cycleup = p_cycleup ? static_cast<int>(p_cycleup->GetValue()) : 100;
-    int cycledown = p_cycledown ? static_cast<int>(p_cycledown->GetValue()) : 100;
-
-    if (!p_core || !p_cycles || !p_cycleup || !p_cycledown || !p_arch) {
-        printf("[CPU] CPU_Change_Config: Some properties missing, using defaults: core=%s, cputype=%s, cycles=%d, cycleup=%d, cycledown=%d",
-                core.c_str(), cputype.c_str(), cycles, cycleup, cycledown);
-    } else {
-        printf("[CPU] CPU_Change_Config: core=%s, cputype=%s, cycles=%d, cycleup=%d, cycledown=%d",
-                core.c_str(), cputype.c_str(), cycles, cycleup, cycledown);
+    std::string core = section->Get_string("core");
+    std::string cputype = section->Get_string("cputype");
+    int cycleup = section->Get_int("cycleup");
+    int cycledown = section->Get_int("cycledown");
+
+    // cycles is "auto", "max", "fixed <n>" or a plain number, anything but a
+    // fixed amount leaves the cycles to the auto adjustment
+    int cycles = 0;
+    Prop_multival_remain* p_cycles = section->Get_multivalremain("cycles");
+    if (p_cycles) {
+        std::string type = p_cycles->GetSection()->Get_string("type");
+        if (type == "fixed") {
+            cycles = atoi(p_cycles->GetSection()->Get_string("parameters"));
+        } else if (type != "auto" && type != "max") {
+            cycles = atoi(type.c_str());
+        }
     }
+    printf("[CPU] CPU_Change_Config: core=%s, cputype=%s, cycles=%d, cycleup=%d, cycledown=%d",
+            core.c_str(), cputype.c_str(), cycles, cycleup, cycledown);
 
     if (core == "auto") {
         CPU_AutoDetermineMode |= CPU_AUTODETERMINE_CORE;
@@ -1830,8 +1821,10 @@ void CPU_Change_Config(Section* newconfig) {
     }
 #endif
 #if (C_DYNREC)
-    else if (core == "dynrec") {
+    else if (core == "dynrec" || core == "dynamic") {
         cpudecoder = &CPU_Core_Dynrec_Run;
+        CPU_Core_Dynrec_Cache_Init(true);
+        CPU_Core_Dynrec_Cache_File(section->Get_path("dynamic_cache")->realpath.c_str());
         CPU_AutoDetermineMode &= ~CPU_AUTODETERMINE_CORE;
     }
 #endif
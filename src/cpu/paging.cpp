@@ -29,6 +29,7 @@
 #include "cpu.h"
 #include "debug.h"
 #include "setup.h"
+#include "timer.h"
 
 #define LINK_TOTAL		(64*1024)
 
@@ -625,6 +626,29 @@ bool PAGING_MakePhysPage(Bitu & page) {
 static InitPageHandler init_page_handler;
 static InitPageUserROHandler init_page_handler_userro;
 
+/* TLB flush counters, reported once per emulated second when logging and
+ * summed up on shutdown. Ranged flushes come from PAGING_InvalidatePages. */
+static struct {
+	Bitu full,ranged,pages;
+	Bitu ticks;
+	Bitu peak_full,peak_ranged;
+	Bit64u total_full,total_ranged;
+} tlb_flushes;
+
+static void PAGING_FlushTick(void) {
+	if (++tlb_flushes.ticks<1000) return;
+	if (tlb_flushes.full || tlb_flushes.ranged) {
+		LOG(LOG_PAGING,LOG_NORMAL)("TLB flushes/s: %d full, %d ranged over %d pages",
+			tlb_flushes.full,tlb_flushes.ranged,tlb_flushes.pages);
+	}
+	if (tlb_flushes.full>tlb_flushes.peak_full) tlb_flushes.peak_full=tlb_flushes.full;
+	if (tlb_flushes.ranged>tlb_flushes.peak_ranged) tlb_flushes.peak_ranged=tlb_flushes.ranged;
+	tlb_flushes.total_full+=tlb_flushes.full;
+	tlb_flushes.total_ranged+=tlb_flushes.ranged;
+	tlb_flushes.full=tlb_flushes.ranged=tlb_flushes.pages=0;
+	tlb_flushes.ticks=0;
+}
+
 
 Bitu PAGING_GetDirBase(void) {
 	return paging.cr3;
@@ -643,7 +667,127 @@ bool PAGING_ForcePageInit(Bitu lin_addr) {
 	return false;
 }
 
-#if defined(USE_FULL_TLB)
+#if defined(USE_SPARSE_TLB)
+static tlb_chunk tlb_clear_chunk;
+
+// Get the chunk holding lin_page for filling in an entry
+static tlb_chunk * TLB_FillChunk(Bitu lin_page) {
+	tlb_chunk * &chunk=paging.tlbdir[lin_page >> TLB_CHUNK_SHIFT];
+	if (GCC_UNLIKELY(chunk==&tlb_clear_chunk)) {
+		chunk=(tlb_chunk *)malloc(sizeof(tlb_chunk));
+		if (!chunk) E_Exit("Out of Memory");
+		memcpy(chunk,&tlb_clear_chunk,sizeof(tlb_chunk));
+	}
+	return chunk;
+}
+
+static INLINE void TLB_ClearEntry(Bitu lin_page) {
+	tlb_chunk * chunk=paging.tlbdir[lin_page >> TLB_CHUNK_SHIFT];
+	if (chunk==&tlb_clear_chunk) return;
+	Bitu index=lin_page & TLB_CHUNK_MASK;
+	chunk->read[index]=0;
+	chunk->write[index]=0;
+	chunk->readhandler[index]=&init_page_handler;
+	chunk->writehandler[index]=&init_page_handler;
+}
+
+void PAGING_InitTLB(void) {
+	for (Bitu i=0;i<TLB_CHUNK_SIZE;i++) {
+		tlb_clear_chunk.read[i]=0;
+		tlb_clear_chunk.write[i]=0;
+		tlb_clear_chunk.readhandler[i]=&init_page_handler;
+		tlb_clear_chunk.writehandler[i]=&init_page_handler;
+		tlb_clear_chunk.phys_page[i]=0;
+	}
+	for (Bitu i=0;i<TLB_CHUNKS;i++) {
+		if (paging.tlbdir[i] && paging.tlbdir[i]!=&tlb_clear_chunk) free(paging.tlbdir[i]);
+		paging.tlbdir[i]=&tlb_clear_chunk;
+	}
+	paging.links.used=0;
+}
+
+void PAGING_ClearTLB(void) {
+	tlb_flushes.full++;
+	Bit32u * entries=&paging.links.entries[0];
+	for (;paging.links.used>0;paging.links.used--) {
+		TLB_ClearEntry(*entries++);
+	}
+	paging.links.used=0;
+}
+
+void PAGING_UnlinkPages(Bitu lin_page,Bitu pages) {
+	for (;pages>0;pages--) {
+		TLB_ClearEntry(lin_page);
+		lin_page++;
+	}
+}
+
+bool PAGING_SetPageWrite(Bitu lin_page,PageHandler * handler,HostPt host) {
+	tlb_chunk * chunk=paging.tlbdir[lin_page >> TLB_CHUNK_SHIFT];
+	if (chunk==&tlb_clear_chunk) return false;
+	Bitu index=lin_page & TLB_CHUNK_MASK;
+	if (chunk->writehandler[index]!=handler) return false;
+	chunk->write[index]=host ? host-(lin_page << 12) : 0;
+	return true;
+}
+
+void PAGING_MapPage(Bitu lin_page,Bitu phys_page) {
+	if (lin_page<LINK_START) {
+		paging.firstmb[lin_page]=phys_page;
+		TLB_ClearEntry(lin_page);
+	} else {
+		PAGING_LinkPage(lin_page,phys_page);
+	}
+}
+
+void PAGING_LinkPage(Bitu lin_page,Bitu phys_page) {
+	PageHandler * handler=MEM_GetPageHandler(phys_page);
+	Bitu lin_base=lin_page << 12;
+	if (lin_page>=TLB_SIZE || phys_page>=TLB_SIZE) 
+		E_Exit("Illegal page");
+
+	if (paging.links.used>=PAGING_LINKS) {
+		LOG(LOG_PAGING,LOG_NORMAL)("Not enough paging links, resetting cache");
+		PAGING_ClearTLB();
+	}
+
+	tlb_chunk * chunk=TLB_FillChunk(lin_page);
+	Bitu index=lin_page & TLB_CHUNK_MASK;
+	chunk->phys_page[index]=phys_page;
+	if (handler->flags & PFLAG_READABLE) chunk->read[index]=handler->GetHostReadPt(phys_page)-lin_base;
+	else chunk->read[index]=0;
+	if (handler->flags & PFLAG_WRITEABLE) chunk->write[index]=handler->GetHostWritePt(phys_page)-lin_base;
+	else chunk->write[index]=0;
+
+	paging.links.entries[paging.links.used++]=lin_page;
+	chunk->readhandler[index]=handler;
+	chunk->writehandler[index]=handler;
+}
+
+void PAGING_LinkPage_ReadOnly(Bitu lin_page,Bitu phys_page) {
+	PageHandler * handler=MEM_GetPageHandler(phys_page);
+	Bitu lin_base=lin_page << 12;
+	if (lin_page>=TLB_SIZE || phys_page>=TLB_SIZE) 
+		E_Exit("Illegal page");
+
+	if (paging.links.used>=PAGING_LINKS) {
+		LOG(LOG_PAGING,LOG_NORMAL)("Not enough paging links, resetting cache");
+		PAGING_ClearTLB();
+	}
+
+	tlb_chunk * chunk=TLB_FillChunk(lin_page);
+	Bitu index=lin_page & TLB_CHUNK_MASK;
+	chunk->phys_page[index]=phys_page;
+	if (handler->flags & PFLAG_READABLE) chunk->read[index]=handler->GetHostReadPt(phys_page)-lin_base;
+	else chunk->read[index]=0;
+	chunk->write[index]=0;
+
+	paging.links.entries[paging.links.used++]=lin_page;
+	chunk->readhandler[index]=handler;
+	chunk->writehandler[index]=&init_page_handler_userro;
+}
+
+#elif defined(USE_FULL_TLB)
 void PAGING_InitTLB(void) {
 	for (Bitu i=0;i<TLB_SIZE;i++) {
 		paging.tlb.read[i]=0;
@@ -655,6 +799,7 @@ void PAGING_InitTLB(void) {
 }
 
 void PAGING_ClearTLB(void) {
+	tlb_flushes.full++;
 	Bit32u * entries=&paging.links.entries[0];
 	for (;paging.links.used>0;paging.links.used--) {
 		Bitu page=*entries++;
@@ -676,6 +821,12 @@ void PAGING_UnlinkPages(Bitu lin_page,Bitu pages) {
 	}
 }
 
+bool PAGING_SetPageWrite(Bitu lin_page,PageHandler * handler,HostPt host) {
+	if (paging.tlb.writehandler[lin_page]!=handler) return false;
+	paging.tlb.write[lin_page]=host ? host-(lin_page << 12) : 0;
+	return true;
+}
+
 void PAGING_MapPage(Bitu lin_page,Bitu phys_page) {
 	if (lin_page<LINK_START) {
 		paging.firstmb[lin_page]=phys_page;
@@ -754,6 +905,7 @@ void PAGING_InitTLB(void) {
 }
 
 void PAGING_ClearTLB(void) {
+	tlb_flushes.full++;
 	Bit32u * entries=&paging.links.entries[0];
 	for (;paging.links.used>0;paging.links.used--) {
 		Bitu page=*entries++;
@@ -777,6 +929,13 @@ void PAGING_UnlinkPages(Bitu lin_page,Bitu pages) {
 	}
 }
 
+bool PAGING_SetPageWrite(Bitu lin_page,PageHandler * handler,HostPt host) {
+	tlb_entry *entry = get_tlb_entry(lin_page<<12);
+	if (entry->writehandler!=handler) return false;
+	entry->write=host ? host-(lin_page << 12) : 0;
+	return true;
+}
+
 void PAGING_MapPage(Bitu lin_page,Bitu phys_page) {
 	if (lin_page<LINK_START) {
 		paging.firstmb[lin_page]=phys_page;
@@ -837,6 +996,15 @@ void PAGING_LinkPage_ReadOnly(Bitu lin_page,Bitu phys_page) {
 #endif
 
 
+
+
+/* Drop the TLB entries of a linear range after its mapping changed, used
+ * instead of a full PAGING_ClearTLB when only a few pages were remapped */
+void PAGING_InvalidatePages(Bitu lin_page,Bitu pages) {
+	tlb_flushes.ranged++;
+	tlb_flushes.pages+=pages;
+	PAGING_UnlinkPages(lin_page,pages);
+}
 void PAGING_SetDirBase(Bitu cr3) {
 	paging.cr3=cr3;
 	
@@ -880,8 +1048,17 @@ public:
 			paging.firstmb[i]=i;
 		}
 		pf_queue.used=0;
+		memset(&tlb_flushes,0,sizeof(tlb_flushes));
+		TIMER_AddTickHandler(PAGING_FlushTick);
+	}
+	~PAGING(){
+		TIMER_DelTickHandler(PAGING_FlushTick);
+		tlb_flushes.total_full+=tlb_flushes.full;
+		tlb_flushes.total_ranged+=tlb_flushes.ranged;
+		LOG_MSG("PAGING: %llu full and %llu ranged TLB flushes, peak %d and %d per second",
+			(unsigned long long)tlb_flushes.total_full,(unsigned long long)tlb_flushes.total_ranged,
+			(int)tlb_flushes.peak_full,(int)tlb_flushes.peak_ranged);
 	}
-	~PAGING(){}
 };
 
 static PAGING* test;
@@ -26,12 +26,15 @@
 #include <string>
 #include <iostream>
 #include <vector>
+#include <list>
+#include <map>
 #include <fstream>
 #include <sstream>
 #include "dosbox.h"
 #include "mem.h"
 #include "mixer.h"
 #include "SDL.h"
+#include "compressed_image.h"
 
 #if defined(C_SDL_SOUND)
 #include "SDL_sound.h"
@@ -150,6 +153,19 @@ private:
 		BinaryFile();
 		std::ifstream *file;
 	};
+
+	// Data track stored in a compressed image container
+	class CompressedFile : public TrackFile {
+	public:
+		CompressedFile(const char *filename, bool &error);
+		~CompressedFile();
+		bool read(Bit8u *buffer, int seek, int count);
+		int getLength();
+	private:
+		CompressedFile();
+		FILE *file;
+		CompressedImage *image;
+	};
 	
 	#if defined(C_SDL_SOUND)
 	class AudioFile : public TrackFile {
@@ -195,9 +211,11 @@ public:
 	bool	ReadSectors		(PhysPt buffer, bool raw, unsigned long sector, unsigned long num);
 	bool	LoadUnloadMedia		(bool unload);
 	bool	ReadSector		(Bit8u *buffer, bool raw, unsigned long sector);
+	bool	ReadSectorsHost		(Bit8u *buffer, bool raw, unsigned long sector, unsigned long num);
 	bool	HasDataTrack		(void);
 	
 static	CDROM_Interface_Image* images[26];
+static	Bitu	cacheSectors;
 
 private:
 	// player
@@ -221,6 +239,7 @@ static  struct imagePlayer {
 	void 	ClearTracks();
 	bool	LoadIsoFile(char *filename);
 	bool	CanReadPVD(TrackFile *file, int sectorSize, bool mode2);
+	TrackFile* OpenDataFile(const char *filename, bool &error);
 	// cue sheet processing
 	bool	LoadCueSheet(char *cuefile);
 	bool	GetRealFileName(std::string& filename, std::string& pathname);
@@ -228,6 +247,23 @@ static  struct imagePlayer {
 	bool	GetCueFrame(int &frames, std::istream &in);
 	bool	GetCueString(std::string &str, std::istream &in);
 	bool	AddTrack(Track &curr, int &shift, int prestart, int &totalPregap, int currPregap);
+	// cooked sector cache, least recently used slots are reused first
+	bool	ReadSectorsDirect(Bit8u *buffer, bool raw, unsigned long sector, unsigned long num);
+	Bit8u*	CacheLookup(Bit32u sector);
+	Bit8u*	CacheInsert(Bit32u sector);
+	void	CacheClear(void);
+	struct CacheSlot {
+		Bit32u sector;
+		std::list<Bitu>::iterator pos;
+	};
+	std::vector<Bit8u>	cacheData;
+	std::vector<CacheSlot>	cacheSlots;
+	std::list<Bitu>	cacheOrder;
+	std::map<Bit32u,Bitu>	cacheMap;
+	std::vector<Bit8u>	cacheFill;
+	std::vector<Bit8u>	splitBuffer;
+	unsigned long	readaheadNext;
+	unsigned long	readahead;
 
 static	int	refCount;
 	std::vector<Track>	tracks;
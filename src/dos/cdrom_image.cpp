@@ -42,6 +42,10 @@ using namespace std;
 
 #define MAX_LINE_LENGTH 512
 #define MAX_FILENAME_LENGTH 256
+// Most sectors fetched ahead of a sequential reader
+#define CD_READAHEAD_MAX 64
+// Sectors per host read when cooked data has to be cut out of raw sectors
+#define CD_SPLIT_CHUNK 64
 
 CDROM_Interface_Image::BinaryFile::BinaryFile(const char *filename, bool &error)
 {
@@ -69,6 +73,32 @@ int CDROM_Interface_Image::BinaryFile::getLength()
 	return length;
 }
 
+CDROM_Interface_Image::CompressedFile::CompressedFile(const char *filename, bool &error)
+{
+	image = NULL;
+	file = fopen(filename, "rb");
+	if (file) image = new CompressedImage(file);
+	error = !image || !image->IsValid();
+}
+
+CDROM_Interface_Image::CompressedFile::~CompressedFile()
+{
+	delete image;
+	if (file) fclose(file);
+}
+
+bool CDROM_Interface_Image::CompressedFile::read(Bit8u *buffer, int seek, int count)
+{
+	if (seek < 0 || count < 0) return false;
+	return image->Read(buffer, (Bit64u)seek, (Bitu)count);
+}
+
+int CDROM_Interface_Image::CompressedFile::getLength()
+{
+	if (image->GetSize() > (Bit64u)INT_MAX) return -1;
+	return (int)image->GetSize();
+}
+
 #if defined(C_SDL_SOUND)
 CDROM_Interface_Image::AudioFile::AudioFile(const char *filename, bool &error)
 {
@@ -129,6 +159,7 @@ int CDROM_Interface_Image::AudioFile::getLength()
 // initialize static members
 int CDROM_Interface_Image::refCount = 0;
 CDROM_Interface_Image* CDROM_Interface_Image::images[26];
+Bitu CDROM_Interface_Image::cacheSectors = 0;
 CDROM_Interface_Image::imagePlayer CDROM_Interface_Image::player = {
 	NULL, NULL, NULL, {0}, 0, 0, 0, false, false, false, {0} };
 
@@ -136,6 +167,8 @@ CDROM_Interface_Image::imagePlayer CDROM_Interface_Image::player = {
 CDROM_Interface_Image::CDROM_Interface_Image(Bit8u subUnit)
 {
 	images[subUnit] = this;
+	readaheadNext = 0;
+	readahead = 0;
 	if (refCount == 0) {
 		player.mutex = SDL_CreateMutex();
 		if (!player.channel) {
@@ -269,11 +302,7 @@ bool CDROM_Interface_Image::ReadSectors(PhysPt buffer, bool raw, unsigned long s
 	Bitu buflen = num * sectorSize;
 	Bit8u* buf = new Bit8u[buflen];
 	
-	bool success = true; //Gobliiins reads 0 sectors
-	for(unsigned long i = 0; i < num; i++) {
-		success = ReadSector(&buf[i * sectorSize], raw, sector + i);
-		if (!success) break;
-	}
+	bool success = ReadSectorsHost(buf, raw, sector, num); //Gobliiins reads 0 sectors
 
 	MEM_BlockWrite(buffer, buf, buflen);
 	delete[] buf;
@@ -302,16 +331,138 @@ int CDROM_Interface_Image::GetTrack(int sector)
 
 bool CDROM_Interface_Image::ReadSector(Bit8u *buffer, bool raw, unsigned long sector)
 {
-	int track = GetTrack(sector) - 1;
-	if (track < 0) return false;
-	
-	int seek = tracks[track].skip + (sector - tracks[track].start) * tracks[track].sectorSize;
+	return ReadSectorsHost(buffer, raw, sector, 1);
+}
+
+// Read a run of sectors with one host read per track, or per chunk when
+// the cooked data has to be cut out of raw sectors
+bool CDROM_Interface_Image::ReadSectorsDirect(Bit8u *buffer, bool raw, unsigned long sector, unsigned long num)
+{
 	int length = (raw ? RAW_SECTOR_SIZE : COOKED_SECTOR_SIZE);
-	if (tracks[track].sectorSize != RAW_SECTOR_SIZE && raw) return false;
-	if (tracks[track].sectorSize == RAW_SECTOR_SIZE && !tracks[track].mode2 && !raw) seek += 16;
-	if (tracks[track].mode2 && !raw) seek += 24;
+	while (num) {
+		int track = GetTrack(sector) - 1;
+		if (track < 0) return false;
+		Track &curr = tracks[track];
+		if (curr.sectorSize != RAW_SECTOR_SIZE && raw) return false;
+
+		unsigned long count = tracks[track + 1].start - sector;
+		if (count > num) count = num;
+		int seek = curr.skip + (sector - curr.start) * curr.sectorSize;
+		int offset = 0;
+		if (curr.sectorSize == RAW_SECTOR_SIZE && !curr.mode2 && !raw) offset += 16;
+		if (curr.mode2 && !raw) offset += 24;
+
+		if (!(curr.attr & 0x40)) {
+			// audio files are decoded one sector at a time
+			count = 1;
+			if (!curr.file->read(buffer, seek + offset, length)) return false;
+		} else if (curr.sectorSize == length) {
+			if (!curr.file->read(buffer, seek, count * length)) return false;
+		} else {
+			if (count > CD_SPLIT_CHUNK) count = CD_SPLIT_CHUNK;
+			int span = (count - 1) * curr.sectorSize + offset + length;
+			if (splitBuffer.size() < (size_t)span) splitBuffer.resize(span);
+			if (!curr.file->read(&splitBuffer[0], seek, span)) return false;
+			for (unsigned long i = 0; i < count; i++)
+				memcpy(&buffer[i * length], &splitBuffer[i * curr.sectorSize + offset], length);
+		}
+		buffer += count * length;
+		sector += count;
+		num -= count;
+	}
+	return true;
+}
 
-	return tracks[track].file->read(buffer, seek, length);
+// Cooked reads go through the sector cache, a miss fetches the rest of the
+// request together with a readahead that doubles while the reader stays
+// sequential. Raw reads are mostly CD audio and bypass it.
+bool CDROM_Interface_Image::ReadSectorsHost(Bit8u *buffer, bool raw, unsigned long sector, unsigned long num)
+{
+	if (raw || !cacheSectors) return ReadSectorsDirect(buffer, raw, sector, num);
+	if (cacheSlots.size() != cacheSectors) {
+		CacheClear();
+		cacheSlots.resize(cacheSectors);
+		cacheData.resize(cacheSectors * COOKED_SECTOR_SIZE);
+	}
+
+	if (sector == readaheadNext) {
+		readahead = readahead ? readahead * 2 : 4;
+		if (readahead > CD_READAHEAD_MAX) readahead = CD_READAHEAD_MAX;
+		if (readahead > cacheSectors / 2) readahead = cacheSectors / 2;
+	} else readahead = 0;
+	readaheadNext = sector + num;
+
+	while (num) {
+		Bit8u* data = CacheLookup(sector);
+		if (data) {
+			memcpy(buffer, data, COOKED_SECTOR_SIZE);
+			buffer += COOKED_SECTOR_SIZE;
+			sector++;
+			num--;
+			continue;
+		}
+		// larger than the whole cache, stream it past
+		if (num > cacheSectors) return ReadSectorsDirect(buffer, false, sector, num);
+
+		int track = GetTrack(sector) - 1;
+		if (track < 0) return false;
+		unsigned long limit = tracks[track + 1].start - sector;
+		unsigned long count = num + readahead;
+		if (count > limit) count = limit;
+		if (count > cacheSectors) count = cacheSectors;
+		if (cacheFill.size() < count * COOKED_SECTOR_SIZE) cacheFill.resize(count * COOKED_SECTOR_SIZE);
+		if (!ReadSectorsDirect(&cacheFill[0], false, sector, count)) {
+			// the readahead may run past the end of a short image
+			if (count <= num) return false;
+			count = num < limit ? num : limit;
+			if (!ReadSectorsDirect(&cacheFill[0], false, sector, count)) return false;
+		}
+		for (unsigned long i = 0; i < count; i++)
+			memcpy(CacheInsert(sector + i), &cacheFill[i * COOKED_SECTOR_SIZE], COOKED_SECTOR_SIZE);
+
+		unsigned long used = count < num ? count : num;
+		memcpy(buffer, &cacheFill[0], used * COOKED_SECTOR_SIZE);
+		buffer += used * COOKED_SECTOR_SIZE;
+		sector += used;
+		num -= used;
+	}
+	return true;
+}
+
+Bit8u* CDROM_Interface_Image::CacheLookup(Bit32u sector)
+{
+	std::map<Bit32u,Bitu>::iterator it = cacheMap.find(sector);
+	if (it == cacheMap.end()) return NULL;
+	CacheSlot &slot = cacheSlots[it->second];
+	cacheOrder.splice(cacheOrder.begin(), cacheOrder, slot.pos);
+	return &cacheData[it->second * COOKED_SECTOR_SIZE];
+}
+
+Bit8u* CDROM_Interface_Image::CacheInsert(Bit32u sector)
+{
+	Bit8u* data = CacheLookup(sector);
+	if (data) return data;
+	Bitu index;
+	if (cacheOrder.size() < cacheSlots.size()) {
+		index = cacheOrder.size();
+		cacheOrder.push_front(index);
+		cacheSlots[index].pos = cacheOrder.begin();
+	} else {
+		index = cacheOrder.back();
+		cacheMap.erase(cacheSlots[index].sector);
+		cacheOrder.splice(cacheOrder.begin(), cacheOrder, cacheSlots[index].pos);
+	}
+	cacheSlots[index].sector = sector;
+	cacheMap[sector] = index;
+	return &cacheData[index * COOKED_SECTOR_SIZE];
+}
+
+void CDROM_Interface_Image::CacheClear(void)
+{
+	cacheMap.clear();
+	cacheOrder.clear();
+	readaheadNext = 0;
+	readahead = 0;
 }
 
 void CDROM_Interface_Image::CDAudioCallBack(Bitu len)
@@ -372,7 +523,7 @@ bool CDROM_Interface_Image::LoadIsoFile(char* filename)
 	// data track
 	Track track = {0, 0, 0, 0, 0, 0, false, NULL};
 	bool error;
-	track.file = new BinaryFile(filename, error);
+	track.file = OpenDataFile(filename, error);
 	if (error) {
 		delete track.file;
 		return false;
@@ -409,6 +560,15 @@ bool CDROM_Interface_Image::LoadIsoFile(char* filename)
 	return true;
 }
 
+CDROM_Interface_Image::TrackFile* CDROM_Interface_Image::OpenDataFile(const char *filename, bool &error)
+{
+	FILE *probe = fopen(filename, "rb");
+	bool compressed = probe && CompressedImage::Detect(probe);
+	if (probe) fclose(probe);
+	if (compressed) return new CompressedFile(filename, error);
+	return new BinaryFile(filename, error);
+}
+
 bool CDROM_Interface_Image::CanReadPVD(TrackFile *file, int sectorSize, bool mode2)
 {
 	Bit8u pvd[COOKED_SECTOR_SIZE];
@@ -526,7 +686,7 @@ bool CDROM_Interface_Image::LoadCueSheet(char *cuefile)
 			track.file = NULL;
 			bool error = true;
 			if (type == "BINARY") {
-				track.file = new BinaryFile(filename.c_str(), error);
+				track.file = OpenDataFile(filename.c_str(), error);
 			}
 #if defined(C_SDL_SOUND)
 			//The next if has been surpassed by the else, but leaving it in as not 
@@ -739,6 +899,7 @@ void CDROM_Interface_Image::ClearTracks()
 		i++;
 	}
 	tracks.clear();
+	CacheClear();
 }
 
 void CDROM_Image_Destroy(Section*) {
@@ -748,6 +909,8 @@ void CDROM_Image_Destroy(Section*) {
 }
 
 void CDROM_Image_Init(Section* section) {
+	Section_prop * sect = static_cast<Section_prop *>(section);
+	CDROM_Interface_Image::cacheSectors = sect->Get_int("cdcache") * 1024 / COOKED_SECTOR_SIZE;
 #if defined(C_SDL_SOUND)
 	Sound_Init();
 	section->AddDestroyFunction(CDROM_Image_Destroy, false);
@@ -0,0 +1,272 @@
+/*
+ *  Copyright (C) 2002-2015  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+
+#include <string.h>
+#include "dosbox.h"
+#include "compressed_image.h"
+
+#if defined(C_ZLIB)
+#define WANT_ZLIB
+#include <compat/zlib.h>
+#endif
+
+/* CISO header: "CISO", header size, image size (64 bit), hunk size,
+ * version, index shift, 2 reserved bytes. The index of hunk offsets
+ * follows, one entry more than there are hunks so the last one gives the
+ * end of the final hunk. The top bit marks a hunk that is stored as is. */
+#define CISO_HEADER_SIZE	24
+#define CISO_STORED		0x80000000
+#define CISO_MAX_HUNK		(1024*1024)
+
+// Decompressed hunks kept around, and how far sequential readers are served ahead
+#define CIMG_CACHE_BYTES	(4*1024*1024)
+#define CIMG_PREFETCH_BYTES	(256*1024)
+#define CIMG_WORKERS		2
+
+static inline Bit32u GetLE32(const Bit8u *p) {
+	return (Bit32u)p[0] | ((Bit32u)p[1] << 8) | ((Bit32u)p[2] << 16) | ((Bit32u)p[3] << 24);
+}
+
+static bool ReadHeader(FILE *file, Bit8u *header) {
+	long pos = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	bool ok = fread(header, 1, CISO_HEADER_SIZE, file) == CISO_HEADER_SIZE && !memcmp(header, "CISO", 4);
+	fseek(file, pos, SEEK_SET);
+	return ok;
+}
+
+bool CompressedImage::Detect(FILE *file) {
+	Bit8u header[CISO_HEADER_SIZE];
+	return ReadHeader(file, header);
+}
+
+Bit64u CompressedImage::GetImageSize(FILE *file) {
+	Bit8u header[CISO_HEADER_SIZE];
+	if (ReadHeader(file, header)) return GetLE32(&header[8]) | ((Bit64u)GetLE32(&header[12]) << 32);
+	fseek(file, 0, SEEK_END);
+	return (Bit64u)ftell(file);
+}
+
+#if !defined(C_ZLIB)
+
+CompressedImage::CompressedImage(FILE * /*file*/) : valid(false), size(0) {
+	LOG_MSG("ImageLoader: compressed images need zlib support");
+}
+
+CompressedImage::~CompressedImage() {
+}
+
+bool CompressedImage::Read(Bit8u * /*buffer*/, Bit64u /*offset*/, Bitu /*count*/) {
+	return false;
+}
+
+#else
+
+static z_stream * NewStream(void) {
+	z_stream *zs = new z_stream;
+	memset(zs, 0, sizeof(z_stream));
+	if (inflateInit2(zs, -MAX_WBITS) != Z_OK) {
+		delete zs;
+		return NULL;
+	}
+	return zs;
+}
+
+static void FreeStream(void *stream) {
+	if (!stream) return;
+	inflateEnd((z_stream *)stream);
+	delete (z_stream *)stream;
+}
+
+CompressedImage::CompressedImage(FILE *file) : valid(false), size(0), file(file),
+	hunkSize(0), hunkCount(0), align(0), cacheHunks(0), nextOffset(~(Bit64u)0), stream(NULL), quit(false) {
+	Bit8u header[CISO_HEADER_SIZE];
+	if (!ReadHeader(file, header)) return;
+	size = GetLE32(&header[8]) | ((Bit64u)GetLE32(&header[12]) << 32);
+	hunkSize = GetLE32(&header[16]);
+	align = header[21];
+	if (header[20] > 1 || hunkSize < 512 || hunkSize > CISO_MAX_HUNK || (hunkSize & (hunkSize - 1))) {
+		LOG_MSG("ImageLoader: unsupported compressed image version %d, hunk size %d", header[20], (int)hunkSize);
+		return;
+	}
+	hunkCount = (Bitu)((size + hunkSize - 1) / hunkSize);
+
+	std::vector<Bit8u> raw((hunkCount + 1) * 4);
+	fseek(file, CISO_HEADER_SIZE, SEEK_SET);
+	if (fread(&raw[0], 1, raw.size(), file) != raw.size()) return;
+	index.resize(hunkCount + 1);
+	for (Bitu i = 0; i <= hunkCount; i++) index[i] = GetLE32(&raw[i * 4]);
+
+	stream = NewStream();
+	if (!stream) return;
+	cacheHunks = CIMG_CACHE_BYTES / hunkSize;
+	if (cacheHunks < 16) cacheHunks = 16;
+	valid = true;
+#if defined(C_IMAGE_PREFETCH)
+	for (Bitu i = 0; i < CIMG_WORKERS; i++)
+		workers.push_back(std::thread(&CompressedImage::Worker, this));
+#endif
+}
+
+CompressedImage::~CompressedImage() {
+#if defined(C_IMAGE_PREFETCH)
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		quit = true;
+	}
+	wake.notify_all();
+	for (size_t i = 0; i < workers.size(); i++) workers[i].join();
+#endif
+	FreeStream(stream);
+}
+
+bool CompressedImage::Decode(Bit32u hunk, std::vector<Bit8u> &out, std::vector<Bit8u> &in, void *zstream) {
+	Bit64u start = (Bit64u)(index[hunk] & ~CISO_STORED) << align;
+	Bit64u end = (Bit64u)(index[hunk + 1] & ~CISO_STORED) << align;
+	Bitu length = hunkSize;
+	if ((Bit64u)hunk * hunkSize + length > size) length = (Bitu)(size - (Bit64u)hunk * hunkSize);
+	// the aligned end may include padding, but never more than a stored hunk
+	if (end <= start || end - start > (Bit64u)hunkSize + ((Bit64u)1 << align) + 64) return false;
+	Bitu packed = (Bitu)(end - start);
+	in.resize(packed);
+	out.resize(length);
+	{
+		std::lock_guard<std::mutex> guard(fileLock);
+		if (fseek(file, (long)start, SEEK_SET) || fread(&in[0], 1, packed, file) != packed) {
+			// the last hunk may be shorter than its padded index entry claims
+			if (!feof(file)) return false;
+		}
+	}
+	if (index[hunk] & CISO_STORED) {
+		if (packed < length) return false;
+		memcpy(&out[0], &in[0], length);
+		return true;
+	}
+	z_stream *zs = (z_stream *)zstream;
+	inflateReset(zs);
+	zs->next_in = &in[0];
+	zs->avail_in = (uInt)packed;
+	zs->next_out = &out[0];
+	zs->avail_out = (uInt)length;
+	int ret = inflate(zs, Z_FINISH);
+	return (ret == Z_STREAM_END || ret == Z_OK || ret == Z_BUF_ERROR) && zs->avail_out == 0;
+}
+
+// Called with lock held
+bool CompressedImage::CopyCached(Bit32u hunk, Bit8u *buffer, Bitu offset, Bitu count) {
+	std::map<Bit32u,Hunk>::iterator it = hunks.find(hunk);
+	if (it == hunks.end()) return false;
+	order.splice(order.begin(), order, it->second.pos);
+	memcpy(buffer, &it->second.data[offset], count);
+	return true;
+}
+
+// Called with lock held, takes over the contents of data
+void CompressedImage::Insert(Bit32u hunk, std::vector<Bit8u> &data) {
+	if (hunks.find(hunk) != hunks.end()) return;
+	Hunk &entry = hunks[hunk];
+	entry.data.swap(data);
+	order.push_front(hunk);
+	entry.pos = order.begin();
+	while (hunks.size() > cacheHunks) {
+		hunks.erase(order.back());
+		order.pop_back();
+	}
+}
+
+// Called with lock held
+void CompressedImage::Prefetch(Bit32u first, Bit32u last) {
+#if defined(C_IMAGE_PREFETCH)
+	if (last >= hunkCount) last = (Bit32u)hunkCount - 1;
+	for (Bit32u hunk = first; hunk <= last; hunk++) {
+		if (hunks.count(hunk) || queued.count(hunk) || inflight.count(hunk)) continue;
+		queue.push_back(hunk);
+		queued.insert(hunk);
+	}
+	wake.notify_all();
+#endif
+}
+
+void CompressedImage::Worker(void) {
+	z_stream *zs = NewStream();
+	std::vector<Bit8u> in, out;
+	std::unique_lock<std::mutex> guard(lock);
+	while (!quit) {
+		if (queue.empty() || !zs) {
+			wake.wait(guard);
+			continue;
+		}
+		Bit32u hunk = queue.front();
+		queue.pop_front();
+		// taken over by a reader or dropped after a seek
+		if (!queued.erase(hunk)) continue;
+		inflight.insert(hunk);
+		guard.unlock();
+		bool ok = Decode(hunk, out, in, zs);
+		guard.lock();
+		if (ok) Insert(hunk, out);
+		inflight.erase(hunk);
+		done.notify_all();
+	}
+	FreeStream(zs);
+}
+
+bool CompressedImage::Read(Bit8u *buffer, Bit64u offset, Bitu count) {
+	if (!valid || offset + count > size) return false;
+	if (!count) return true;
+	bool sequential = (offset == nextOffset);
+	nextOffset = offset + count;
+	Bit32u last = (Bit32u)((offset + count - 1) / hunkSize);
+
+	if (!sequential) {
+		std::lock_guard<std::mutex> guard(lock);
+		queue.clear();
+		queued.clear();
+	}
+	while (count) {
+		Bit32u hunk = (Bit32u)(offset / hunkSize);
+		Bitu pos = (Bitu)(offset % hunkSize);
+		Bitu chunk = hunkSize - pos;
+		if (chunk > count) chunk = count;
+		bool cached;
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			// a worker is inflating it right now
+			while (inflight.count(hunk)) done.wait(guard);
+			cached = CopyCached(hunk, buffer, pos, chunk);
+			if (!cached) queued.erase(hunk);
+		}
+		if (!cached) {
+			if (!Decode(hunk, scratchOut, scratchIn, stream)) return false;
+			memcpy(buffer, &scratchOut[pos], chunk);
+			std::lock_guard<std::mutex> guard(lock);
+			Insert(hunk, scratchOut);
+		}
+		buffer += chunk;
+		offset += chunk;
+		count -= chunk;
+	}
+	if (sequential) {
+		std::lock_guard<std::mutex> guard(lock);
+		Prefetch(last + 1, last + (CIMG_PREFETCH_BYTES + hunkSize - 1) / hunkSize);
+	}
+	return true;
+}
+
+#endif
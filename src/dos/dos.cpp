@@ -177,6 +177,7 @@ static Bitu DOS_21Handler(void) {
 				if (!DOS_GetSTDINStatus()) {
 					reg_al=0;
 					CALLBACK_SZF(true);
+					CALLBACK_IdlePoll();
 					break;
 				}
 				Bit8u c;Bit16u n=1;
@@ -259,7 +260,7 @@ static Bitu DOS_21Handler(void) {
 			break;
 		};
 	case 0x0b:		/* Get STDIN Status */
-		if (!DOS_GetSTDINStatus()) {reg_al=0x00;}
+		if (!DOS_GetSTDINStatus()) {reg_al=0x00;CALLBACK_IdlePoll();}
 		else {reg_al=0xFF;}
 		//Simulate some overhead for timing issues
 		//Tankwar menu (needs maybe even more)
@@ -1680,6 +1681,12 @@ static Bitu DOS_20Handler(void) {
 	return CBRET_NONE;
 }
 
+static Bitu DOS_28Handler(void) {
+	// DOS idle interrupt, called by programs waiting for input
+	CALLBACK_IdlePoll();
+	return CBRET_NONE;
+}
+
 static Bitu DOS_27Handler(void) {
 	// Terminate & stay resident
 	Bit16u para = (reg_dx/16)+((reg_dx % 16)>0);
@@ -1741,7 +1748,7 @@ public:
 		callback[4].Install(DOS_27Handler,CB_IRET,"DOS Int 27");
 		callback[4].Set_RealVec(0x27);
 
-		callback[5].Install(NULL,CB_IRET,"DOS Int 28");
+		callback[5].Install(DOS_28Handler,CB_IRET,"DOS Int 28");
 		callback[5].Set_RealVec(0x28);
 
 		callback[6].Install(NULL,CB_INT29,"CON Output Int 29");
@@ -36,6 +36,7 @@
 #include "dos_inc.h"
 #include "bios.h"
 #include "bios_disk.h" 
+#include "compressed_image.h"
 #include "setup.h"
 #include "control.h"
 #include "inout.h"
@@ -524,9 +525,8 @@ private:
 			}
 
 			// get file size
-			fseek(tmpfile,0L, SEEK_END);
-			*ksize = (ftell(tmpfile) / 1024);
-			*bsize = ftell(tmpfile);
+			*bsize = (Bit32u)CompressedImage::GetImageSize(tmpfile);
+			*ksize = *bsize / 1024;
 			fclose(tmpfile);
 
 			tmpfile = ldp->GetSystemFilePtr(fullname, "rb+");
@@ -562,9 +562,8 @@ private:
 //				fclose(tmpfile);
 //				if(tryload) error = 2;
 				WriteOut(MSG_Get("PROGRAM_BOOT_WRITE_PROTECTED"));
-				fseek(tmpfile,0L, SEEK_END);
-				*ksize = (ftell(tmpfile) / 1024);
-				*bsize = ftell(tmpfile);
+				*bsize = (Bit32u)CompressedImage::GetImageSize(tmpfile);
+				*ksize = *bsize / 1024;
 				return tmpfile;
 			}
 			// Give the delayed errormessages from the mounted variant (or from above)
@@ -572,9 +571,8 @@ private:
 			if(error == 2) WriteOut(MSG_Get("PROGRAM_BOOT_NOT_OPEN"));
 			return NULL;
 		}
-		fseek(tmpfile,0L, SEEK_END);
-		*ksize = (ftell(tmpfile) / 1024);
-		*bsize = ftell(tmpfile);
+		*bsize = (Bit32u)CompressedImage::GetImageSize(tmpfile);
+		*ksize = *bsize / 1024;
 		return tmpfile;
 	}
 
@@ -1276,11 +1274,17 @@ public:
 						WriteOut(MSG_Get("PROGRAM_IMGMOUNT_INVALID_IMAGE"));
 						return;
 					}
-					fseek(diskfile, 0L, SEEK_END);
-					Bit32u fcsize = (Bit32u)(ftell(diskfile) / 512L);
+					Bit32u fcsize = (Bit32u)(CompressedImage::GetImageSize(diskfile) / 512L);
 					Bit8u buf[512];
-					fseek(diskfile, 0L, SEEK_SET);
-					if (fread(buf,sizeof(Bit8u),512,diskfile)<512) {
+					bool mbrread;
+					if (CompressedImage::Detect(diskfile)) {
+						CompressedImage image(diskfile);
+						mbrread = image.Read(buf, 0, 512);
+					} else {
+						fseek(diskfile, 0L, SEEK_SET);
+						mbrread = fread(buf,sizeof(Bit8u),512,diskfile) == 512;
+					}
+					if (!mbrread) {
 						fclose(diskfile);
 						WriteOut(MSG_Get("PROGRAM_IMGMOUNT_INVALID_IMAGE"));
 						return;
@@ -1421,8 +1425,7 @@ public:
 					WriteOut(MSG_Get("PROGRAM_IMGMOUNT_INVALID_IMAGE"));
 					return;
 				}
-				fseek(newDisk,0L, SEEK_END);
-				imagesize = (ftell(newDisk) / 1024);
+				imagesize = (Bit32u)(CompressedImage::GetImageSize(newDisk) / 1024);
 
 				newImage = new imageDisk(newDisk, (Bit8u *)temp_line.c_str(), imagesize, (imagesize > 2880));
 				if(imagesize>2880) newImage->Set_Geometry(sizes[2],sizes[3],sizes[1],sizes[0]);
@@ -64,7 +64,7 @@ bool SortByDirNameRev(DOS_Drive_Cache::CFileInfo* const &a, DOS_Drive_Cache::CFi
 
 DOS_Drive_Cache::DOS_Drive_Cache(void) {
 	dirBase			= new CFileInfo;
-	save_dir		= 0;
+	pathGeneration		= 0;
 	srchNr			= 0;
 	label[0]		= 0;
 	nextFreeFindFirst	= 0;
@@ -75,7 +75,7 @@ DOS_Drive_Cache::DOS_Drive_Cache(void) {
 
 DOS_Drive_Cache::DOS_Drive_Cache(const char* path) {
 	dirBase			= new CFileInfo;
-	save_dir		= 0;
+	pathGeneration		= 0;
 	srchNr			= 0;
 	label[0]		= 0;
 	nextFreeFindFirst	= 0;
@@ -100,7 +100,8 @@ void DOS_Drive_Cache::EmptyCache(void) {
 	// Empty Cache and reinit
 	Clear();
 	dirBase		= new CFileInfo;
-	save_dir	= 0;
+	pathCache.clear();
+	pathGeneration++;
 	srchNr		= 0;
 	SetBaseDir(basePath);
 }
@@ -217,6 +218,7 @@ void DOS_Drive_Cache::AddEntry(const char* path, bool checkExists) {
 		char sfile[DOS_NAMELENGTH];
 		sfile[0]=0;
 		CreateEntry(dir,file,sfile,false);
+		pathGeneration++;
 		
 		Bits index = GetLongName(dir,file);
 		if (index>=0) {
@@ -277,7 +279,7 @@ void DOS_Drive_Cache::CacheOut(const char* path, bool ignoreLastDir) {
 	// clear lists
 	dir->fileList.clear();
 	dir->longNameList.clear();
-	save_dir = 0;
+	pathGeneration++;
 }
 
 bool DOS_Drive_Cache::IsCachedIn(CFileInfo* curDir) {
@@ -583,9 +585,11 @@ DOS_Drive_Cache::CFileInfo* DOS_Drive_Cache::FindDirInfo(const char* path, char*
 	CFileInfo*	curDir = dirBase;
 	Bit16u		id;
 
-	if (save_dir && (strcmp(path,save_path)==0)) {
-		strcpy(expandedPath,save_expanded);
-		return save_dir;
+	std::string key(path);
+	std::unordered_map<std::string,CachedPath>::iterator cached = pathCache.find(key);
+	if (cached != pathCache.end() && cached->second.generation == pathGeneration) {
+		strcpy(expandedPath,cached->second.expanded.c_str());
+		return cached->second.dir;
 	};
 
 //	LOG_DEBUG("DIR: Find %s",path);
@@ -649,10 +653,15 @@ DOS_Drive_Cache::CFileInfo* DOS_Drive_Cache::FindDirInfo(const char* path, char*
 		}
 	} while (pos);
 
-	// Save last result for faster access next time
-	strcpy(save_path,path);
-	strcpy(save_expanded,expandedPath);
-	save_dir = curDir;
+	// Save result for faster access next time, stale entries are dropped in bulk.
+	// Directories that could not be read are retried on the next lookup.
+	if (IsCachedIn(curDir)) {
+		if (pathCache.size() >= MAX_CACHEDPATHS) pathCache.clear();
+		CachedPath &entry = pathCache[key];
+		entry.dir = curDir;
+		entry.expanded = expandedPath;
+		entry.generation = pathGeneration;
+	}
 
 	return curDir;
 }
@@ -30,6 +30,7 @@
 #include "cross.h"
 #include "bios.h"
 #include "bios_disk.h"
+#include "compressed_image.h"
 
 #define IMGTYPE_FLOPPY 0
 #define IMGTYPE_ISO    1
@@ -646,8 +647,7 @@ fatDrive::fatDrive(const char *sysFilename, Bit32u bytesector, Bit32u cylsector,
 
 	diskfile = fopen(sysFilename, "rb+");
 	if(!diskfile) {created_successfully = false;return;}
-	fseek(diskfile, 0L, SEEK_END);
-	filesize = (Bit32u)ftell(diskfile) / 1024L;
+	filesize = (Bit32u)(CompressedImage::GetImageSize(diskfile) / 1024L);
 
 	/* Load disk image */
 	loadedDisk = new imageDisk(diskfile, (Bit8u *)sysFilename, filesize, (filesize > 2880));
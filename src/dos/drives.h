@@ -349,6 +349,7 @@ public:
 	virtual bool isRemovable(void);
 	virtual Bits UnMount(void);
 	bool readSector(Bit8u *buffer, Bit32u sector);
+	bool readSectors(Bit8u *buffer, Bit32u sector, Bit32u num);
 	virtual char const* GetLabel(void) {return discLabel;};
 	virtual void Activate(void);
 private:
@@ -27,6 +27,17 @@
 #include "fpu.h"
 #include "cpu.h"
 
+#if C_CORE_INLINE
+#include "paging.h"
+/* Memory operands take the inlined TLB path, like the interpreter cores */
+#define mem_readb(off) mem_readb_inline(off)
+#define mem_readw(off) mem_readw_inline(off)
+#define mem_readd(off) mem_readd_inline(off)
+#define mem_writeb(off,val) mem_writeb_inline(off,val)
+#define mem_writew(off,val) mem_writew_inline(off,val)
+#define mem_writed(off,val) mem_writed_inline(off,val)
+#endif
+
 FPU_rec fpu;
 
 void FPU_FLDCW(PhysPt addr){
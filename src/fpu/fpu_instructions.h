@@ -67,11 +67,12 @@ static void FPU_FPOP(void){
 
 static double FROUND(double in){
 	switch(fpu.round){
-	case ROUND_Nearest:	
-		if (in-floor(in)>0.5) return (floor(in)+1);
-		else if (in-floor(in)<0.5) return (floor(in));
-		else return (((static_cast<Bit64s>(floor(in)))&1)!=0)?(floor(in)+1):(floor(in));
-		break;
+	case ROUND_Nearest: {
+		double fl=floor(in);
+		if (in-fl>0.5) return (fl+1);
+		else if (in-fl<0.5) return (fl);
+		else return (((static_cast<Bit64s>(fl))&1)!=0)?(fl+1):(fl);
+		}
 	case ROUND_Down:
 		return (floor(in));
 		break;
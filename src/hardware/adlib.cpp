@@ -28,6 +28,13 @@
 #include "mem.h"
 #include "dbopl.h"
 
+#if C_OPL_THREAD
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
+
 namespace OPL2 {
 	#include "opl.cpp"
 
@@ -85,6 +92,158 @@ namespace OPL3 {
 	};
 }
 
+#if C_OPL_THREAD
+namespace DBOPL {
+	/*
+		Runs the DBOPL synthesis on a worker thread.
+
+		Register writes are queued and handed to the worker together with the
+		request for the next block, so every block sees exactly the writes that
+		preceded its mixer callback, like the synchronous handler. Rendered
+		blocks go into a fifo that starts with one mixer tick of silence; the
+		mixer takes its samples from there while the worker renders the next
+		block. The output only depends on the write order, not on how the
+		threads are scheduled, it is just delayed by that first tick.
+	*/
+	struct ThreadedHandler : public Adlib::Handler {
+		DBOPL::Handler opl;
+		//opl.chip.opl3Active as seen by the emulation, for WriteAddr
+		Bit8u opl3Active;
+
+		std::thread worker;
+		std::mutex lock;
+		std::condition_variable wake;
+		std::condition_variable idle;
+		bool threaded;
+		bool busy;
+		bool quit;
+
+		//Writes since the last block and the ones the worker is replaying
+		std::vector<Bit32u> pending;
+		std::vector<Bit32u> running;
+		Bitu blockSamples;
+		std::vector<Bit32s> block;
+		//Rendered stereo samples waiting for the mixer
+		std::vector<Bit32s> fifo;
+		std::vector<Bit32s> out;
+
+		ThreadedHandler() : opl3Active( 0 ), threaded( false ), busy( false ), quit( false ), blockSamples( 0 ) {
+		}
+		~ThreadedHandler() {
+			if ( threaded ) {
+				{
+					std::lock_guard<std::mutex> guard( lock );
+					quit = true;
+				}
+				wake.notify_one();
+				worker.join();
+			}
+		}
+
+		virtual Bit32u WriteAddr( Bit32u port, Bit8u val ) {
+			//Same as Chip::WriteAddr, the chip itself belongs to the worker
+			switch ( port & 3 ) {
+			case 0:
+				return val;
+			case 2:
+				if ( opl3Active || (val == 0x05) )
+					return 0x100 | val;
+				else
+					return val;
+			}
+			return 0;
+		}
+		virtual void WriteReg( Bit32u addr, Bit8u val ) {
+			if ( addr == 0x105 )
+				opl3Active = ( val & 1 ) ? 0xff : 0;
+			pending.push_back( (addr << 8) | val );
+		}
+		void Replay( const std::vector<Bit32u>& writes ) {
+			for ( size_t i = 0; i < writes.size(); i++ )
+				opl.WriteReg( writes[i] >> 8, writes[i] & 0xff );
+		}
+		//Render stereo samples into block
+		void Render( Bitu samples ) {
+			block.resize( samples * 2 );
+			Bit32s* output = &block[0];
+			while ( samples > 0 ) {
+				Bitu todo = samples > 512 ? 512 : samples;
+				if ( !opl.chip.opl3Active ) {
+					opl.chip.GenerateBlock2( todo, output );
+					//Spread the mono samples, back to front so nothing is overwritten
+					for ( Bitu i = todo; i-- > 0; )
+						output[i * 2] = output[i * 2 + 1] = output[i];
+				} else {
+					opl.chip.GenerateBlock3( todo, output );
+				}
+				output += todo * 2;
+				samples -= todo;
+			}
+		}
+		void Run() {
+			std::unique_lock<std::mutex> guard( lock );
+			for (;;) {
+				wake.wait( guard, [this] { return busy || quit; } );
+				if ( quit )
+					break;
+				guard.unlock();
+				Replay( running );
+				running.clear();
+				Render( blockSamples );
+				guard.lock();
+				fifo.insert( fifo.end(), block.begin(), block.end() );
+				busy = false;
+				idle.notify_one();
+			}
+		}
+		virtual void Generate( MixerChannel* chan, Bitu samples ) {
+			if ( !threaded ) {
+				Replay( pending );
+				pending.clear();
+				opl.Generate( chan, samples );
+				return;
+			}
+			{
+				std::unique_lock<std::mutex> guard( lock );
+				idle.wait( guard, [this] { return !busy; } );
+				running.swap( pending );
+				blockSamples = samples;
+				busy = true;
+				wake.notify_one();
+				//Only wait for this block when the lead is used up
+				if ( fifo.size() < samples * 2 )
+					idle.wait( guard, [this] { return !busy; } );
+				out.assign( fifo.begin(), fifo.begin() + samples * 2 );
+				fifo.erase( fifo.begin(), fifo.begin() + samples * 2 );
+			}
+			chan->AddSamples_s32( samples, &out[0] );
+		}
+		virtual void Init( Bitu rate ) {
+			opl.Init( rate );
+			//One mixer tick of silence ahead of the first block
+			fifo.assign( ( rate / 1000 + 1 ) * 2, 0 );
+			try {
+				worker = std::thread( &ThreadedHandler::Run, this );
+				threaded = true;
+			} catch ( const std::system_error& ) {
+				LOG_MSG( "OPL: Unable to start the synthesis thread, running it inline" );
+			}
+		}
+	};
+}
+
+static Adlib::Handler* NewFastHandler() {
+	//Not worth a thread on a single core
+	if ( std::thread::hardware_concurrency() > 1 )
+		return new DBOPL::ThreadedHandler();
+	return new DBOPL::Handler();
+}
+#else
+static Adlib::Handler* NewFastHandler() {
+	return new DBOPL::Handler();
+}
+#endif
+
 #define RAW_SIZE 1024
 
 
@@ -475,9 +634,29 @@ Bitu Module::CtrlRead( void ) {
 }
 
 
+void Module::CreateHandler( void ) {
+	if (oplemu == "compat") {
+		if ( oplmode == OPL_opl2 ) {
+			handler = new OPL2::Handler();
+		} else {
+			handler = new OPL3::Handler();
+		}
+	} else {
+		handler = NewFastHandler();
+	}
+	handler->Init( rate );
+	//Dual opl2 is emulated with the handler in opl3 mode
+	if ( mode == MODE_DUALOPL2 ) {
+		handler->WriteReg( 0x105, 1 );
+	}
+}
+
 void Module::PortWrite( Bitu port, Bitu val, Bitu iolen ) {
 	//Keep track of last write time
 	lastUsed = PIC_Ticks;
+	if ( !handler ) {
+		CreateHandler();
+	}
 	//Maybe only enable with a keyon?
 	if ( !mixerChan->enabled ) {
 		mixerChan->Enable(true);
@@ -596,9 +775,8 @@ void Module::Init( Mode m ) {
 	case MODE_OPL2:
 		break;
 	case MODE_DUALOPL2:
-		//Setup opl3 mode in the hander
-		handler->WriteReg( 0x105, 1 );
-		//Also set it up in the cache so the capturing will start opl3
+		//Setup opl3 mode in the cache, the handler picks it up when created
+		//and the capturing will start opl3
 		CacheWrite( 0x105, 1 );
 		break;
 	}
@@ -709,20 +887,10 @@ Module::Module( Section* configuration ) : Module_base(configuration) {
 	std::string oplemu( section->Get_string( "oplemu" ) );
 	ctrl.mixer = section->Get_bool("sbmixer");
 
+	this->rate = rate;
+	this->oplemu = oplemu;
 	mixerChan = mixerObject.Install(OPL_CallBack,rate,"FM");
 	mixerChan->SetScale( 2.0 );
-	if (oplemu == "fast") {
-		handler = new DBOPL::Handler();
-	} else if (oplemu == "compat") {
-		if ( oplmode == OPL_opl2 ) {
-			handler = new OPL2::Handler();
-		} else {
-			handler = new OPL3::Handler();
-		}
-	} else {
-		handler = new DBOPL::Handler();
-	}
-	handler->Init( rate );
 	bool single = false;
 	switch ( oplmode ) {
 	case OPL_opl2:
@@ -137,6 +137,10 @@ class Module: public Module_base {
 	void DualWrite( Bit8u index, Bit8u reg, Bit8u val );
 	void CtrlWrite( Bit8u val );
 	Bitu CtrlRead( void );
+	//The synthesis handler is only created on the first write to the chip
+	Bitu rate;
+	std::string oplemu;
+	void CreateHandler( void );
 public:
 	static OPL_Mode oplmode;
 	MixerChannel* mixerChan;
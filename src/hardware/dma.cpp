@@ -41,46 +41,48 @@ static void UpdateEMSMapping(void) {
 	}
 }
 
-/* read a block from physical memory */
-static void DMA_BlockRead(PhysPt spage,PhysPt offset,void * data,Bitu size,Bit8u dma16) {
-	Bit8u * write=(Bit8u *) data;
+/* translate a DMA page, taking care of the EMS pageframe etc. */
+static INLINE Bitu DMA_TranslatePage(Bitu page) {
+	if (page < EMM_PAGEFRAME4K) return paging.firstmb[page];
+	else if (page < EMM_PAGEFRAME4K+0x10) return ems_board_mapping[page];
+	else if (page < LINK_START) return paging.firstmb[page];
+	return page;
+}
+
+/* Walk a transfer in runs that stay within one 4k page and do not cross the
+ * DMA wrap, so each run is a single block of host memory. 16-bit transfers
+ * work on byte offsets shifted by one, so runs always hold whole words. */
+static void DMA_BlockTransfer(PhysPt spage,PhysPt offset,Bit8u * data,Bitu size,Bit8u dma16,bool write) {
 	Bitu highpart_addr_page = spage>>12;
 	size <<= dma16;
 	offset <<= dma16;
 	Bit32u dma_wrap = ((0xffff<<dma16)+dma16) | dma_wrapping;
-	for ( ; size ; size--, offset++) {
+	while (size) {
 		if (offset>(dma_wrapping<<dma16)) {
-			LOG_MSG("DMA segbound wrapping (read): %x:%x size %lx [%x] wrap %x",spage,offset,size,dma16,dma_wrapping);
+			LOG_MSG("DMA segbound wrapping (%s): %x:%x size %lx [%x] wrap %x",write?"write":"read",spage,offset,size,dma16,dma_wrapping);
 		}
 		offset &= dma_wrap;
-		Bitu page = highpart_addr_page+(offset >> 12);
-		/* care for EMS pageframe etc. */
-		if (page < EMM_PAGEFRAME4K) page = paging.firstmb[page];
-		else if (page < EMM_PAGEFRAME4K+0x10) page = ems_board_mapping[page];
-		else if (page < LINK_START) page = paging.firstmb[page];
-		*write++=phys_readb(page*4096 + (offset & 4095));
+		Bitu run = 4096 - (offset & 4095);
+		Bitu left = dma_wrap - offset;
+		if (run - 1 > left) run = left + 1;
+		if (run > size) run = size;
+		HostPt host = MemBase + DMA_TranslatePage(highpart_addr_page+(offset >> 12))*4096 + (offset & 4095);
+		if (write) memcpy(host, data, run);
+		else memcpy(data, host, run);
+		data += run;
+		offset += run;
+		size -= run;
 	}
 }
 
+/* read a block from physical memory */
+static void DMA_BlockRead(PhysPt spage,PhysPt offset,void * data,Bitu size,Bit8u dma16) {
+	DMA_BlockTransfer(spage,offset,(Bit8u *)data,size,dma16,false);
+}
+
 /* write a block into physical memory */
 static void DMA_BlockWrite(PhysPt spage,PhysPt offset,void * data,Bitu size,Bit8u dma16) {
-	Bit8u * read=(Bit8u *) data;
-	Bitu highpart_addr_page = spage>>12;
-	size <<= dma16;
-	offset <<= dma16;
-	Bit32u dma_wrap = ((0xffff<<dma16)+dma16) | dma_wrapping;
-	for ( ; size ; size--, offset++) {
-		if (offset>(dma_wrapping<<dma16)) {
-			LOG_MSG("DMA segbound wrapping (write): %x:%x size %lx [%x] wrap %x",spage,offset,size,dma16,dma_wrapping);
-		}
-		offset &= dma_wrap;
-		Bitu page = highpart_addr_page+(offset >> 12);
-		/* care for EMS pageframe etc. */
-		if (page < EMM_PAGEFRAME4K) page = paging.firstmb[page];
-		else if (page < EMM_PAGEFRAME4K+0x10) page = ems_board_mapping[page];
-		else if (page < LINK_START) page = paging.firstmb[page];
-		phys_writeb(page*4096 + (offset & 4095), *read++);
-	}
+	DMA_BlockTransfer(spage,offset,(Bit8u *)data,size,dma16,true);
 }
 
 DmaChannel * GetDMAChannel(Bit8u chan) {
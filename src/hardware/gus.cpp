@@ -29,6 +29,9 @@
 #include "shell.h"
 #include "math.h"
 #include "regs.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 using namespace std;
 
 //Extra bits of precision over normal gus
@@ -47,6 +50,9 @@ using namespace std;
 
 #define VOL_SHIFT 14
 
+//Samples a voice renders per batch between wave/ramp boundaries
+#define GUS_BATCH 128
+
 #define WCTRL_STOPPED			0x01
 #define WCTRL_STOP				0x02
 #define WCTRL_16BIT				0x04
@@ -58,8 +64,8 @@ using namespace std;
 
 Bit8u adlib_commandreg;
 static MixerChannel * gus_chan;
-static Bit8u irqtable[8] = { 0, 2, 5, 3, 7, 11, 12, 15 };
-static Bit8u dmatable[8] = { 0, 1, 3, 5, 6, 7, 0, 0 };
+static const Bit8u irqtable[8] = { 0, 2, 5, 3, 7, 11, 12, 15 };
+static const Bit8u dmatable[8] = { 0, 1, 3, 5, 6, 7, 0, 0 };
 static Bit8u GUSRam[1024*1024]; // 1024K of GUS Ram
 static Bit16u vol16bit[4096];
 static Bit32u pantable[16];
@@ -161,9 +167,10 @@ public:
 
 	// Returns a single 16-bit sample from the Gravis's RAM
 
-	INLINE Bit32s GetSample8() const {
-		Bit32u useAddr = WaveAddr >> WAVE_FRACT;
-		if (WaveAdd >= (1 << WAVE_FRACT)) {
+	template<bool interpolate>
+	static INLINE Bit32s Sample8(Bit32u addr) {
+		Bit32u useAddr = addr >> WAVE_FRACT;
+		if (!interpolate) {
 			Bit32s tmpsmall = (Bit8s)GUSRam[useAddr];
 			return tmpsmall << 8;
 		}
@@ -173,19 +180,20 @@ public:
 			Bit32s w1 = ((Bit8s)GUSRam[useAddr]) << 8;
 			Bit32s w2 = ((Bit8s)GUSRam[nextAddr]) << 8;
 			Bit32s diff = w2 - w1;
-			Bit32s scale = (Bit32s)(WaveAddr&WAVE_FRACT_MASK);
+			Bit32s scale = (Bit32s)(addr&WAVE_FRACT_MASK);
 			return (w1 + ((diff*scale) >> WAVE_FRACT));
 		}
 	}
 
-	INLINE Bit32s GetSample16() const {
-		Bit32u useAddr = WaveAddr >> WAVE_FRACT;
+	template<bool interpolate>
+	static INLINE Bit32s Sample16(Bit32u addr) {
+		Bit32u useAddr = addr >> WAVE_FRACT;
 		// Formula used to convert addresses for use with 16-bit samples
 		Bit32u holdAddr = useAddr & 0xc0000L;
 		useAddr = useAddr & 0x1ffffL;
 		useAddr = useAddr << 1;
 		useAddr = (holdAddr | useAddr);
-		if (WaveAdd >= (1 << WAVE_FRACT)) {
+		if (!interpolate) {
 			return (GUSRam[useAddr + 0] | (((Bit8s)GUSRam[useAddr + 1]) << 8));
 		}
 		else {
@@ -193,11 +201,28 @@ public:
 			Bit32s w1 = (GUSRam[useAddr + 0] | (((Bit8s)GUSRam[useAddr + 1]) << 8));
 			Bit32s w2 = (GUSRam[useAddr + 2] | (((Bit8s)GUSRam[useAddr + 3]) << 8));
 			Bit32s diff = w2 - w1;
-			Bit32s scale = (Bit32s)(WaveAddr&WAVE_FRACT_MASK);
+			Bit32s scale = (Bit32s)(addr&WAVE_FRACT_MASK);
 			return (w1 + ((diff*scale) >> WAVE_FRACT));
 		}
 	}
 
+	INLINE Bit32s GetSample8() const {
+		if (WaveAdd >= (1 << WAVE_FRACT)) return Sample8<false>(WaveAddr);
+		else return Sample8<true>(WaveAddr);
+	}
+
+	INLINE Bit32s GetSample16() const {
+		if (WaveAdd >= (1 << WAVE_FRACT)) return Sample16<false>(WaveAddr);
+		else return Sample16<true>(WaveAddr);
+	}
+
+	// Fetch a run of samples with a fixed address step, no boundaries inside
+	template<bool bits16, bool interpolate>
+	static void FetchSamples(Bit32s * out,Bitu count,Bit32u addr,Bit32u step) {
+		for (Bitu i = 0; i < count; i++, addr += step)
+			out[i] = bits16 ? Sample16<interpolate>(addr) : Sample8<interpolate>(addr);
+	}
+
 	void WriteWaveFreq(Bit16u val) {
 		WaveFreq = val;
 		double frameadd = double(val >> 1)/512.0;		//Samples / original gus frame
@@ -281,13 +306,16 @@ public:
 			WaveAddr = (WaveCtrl & WCTRL_DECREASING) ? WaveStart : WaveEnd;
 		}
 	}
-	INLINE void UpdateVolumes(void) {
-		Bit32s templeft=RampVol - PanLeft;
+	INLINE void VolumesAt(Bit32u vol,Bit32s &left,Bit32s &right) const {
+		Bit32s templeft=vol - PanLeft;
 		templeft&=~(templeft >> 31);
-		Bit32s tempright=RampVol - PanRight;
+		Bit32s tempright=vol - PanRight;
 		tempright&=~(tempright >> 31);
-		VolLeft=vol16bit[templeft >> RAMP_FRACT];
-		VolRight=vol16bit[tempright >> RAMP_FRACT];
+		left=vol16bit[templeft >> RAMP_FRACT];
+		right=vol16bit[tempright >> RAMP_FRACT];
+	}
+	INLINE void UpdateVolumes(void) {
+		VolumesAt(RampVol,VolLeft,VolRight);
 	}
 	INLINE void RampUpdate(void) {
 		/* Check if ramping enabled */
@@ -320,31 +348,123 @@ public:
 		UpdateVolumes();
 	}
 
+	// Number of WaveUpdate calls that will not hit the loop/stop boundary
+	INLINE Bitu WaveRun(void) const {
+		if (WaveCtrl & ( WCTRL_STOP | WCTRL_STOPPED)) return ~(Bitu)0;
+		Bit32s WaveDist = (WaveCtrl & WCTRL_DECREASING) ? (Bit32s)(WaveAddr-WaveStart) : (Bit32s)(WaveEnd-WaveAddr);
+		if (WaveDist<=0) return 0;
+		if (!WaveAdd) return ~(Bitu)0;
+		return (Bitu)(WaveDist-1)/WaveAdd;
+	}
+	// Number of RampUpdate calls that will not hit the ramp boundary
+	INLINE Bitu RampRun(void) const {
+		if (RampCtrl & 0x3) return ~(Bitu)0;
+		Bit32s RampDist = (RampCtrl & 0x40) ? (Bit32s)(RampVol-RampStart) : (Bit32s)(RampEnd-RampVol);
+		if (RampDist<=0) return 0;
+		if (!RampAdd) return ~(Bitu)0;
+		return (Bitu)(RampDist-1)/RampAdd;
+	}
+
 	void generateSamples(Bit32s * stream,Bit32u len) {
 		//Disabled channel
 		if (RampCtrl & WaveCtrl & 3) return;
 
-		if (WaveCtrl & WCTRL_16BIT) {
-			for (int i = 0; i < (int)len; i++) {
-				// Get sample
-				Bit32s tmpsamp = GetSample16();
-				// Output stereo sample
-				stream[i << 1] += tmpsamp * VolLeft;
-				stream[(i << 1) + 1] += tmpsamp * VolRight;
+		const bool bits16 = (WaveCtrl & WCTRL_16BIT) != 0;
+		const bool interpolate = WaveAdd < (1 << WAVE_FRACT);
+		Bit32s samples[GUS_BATCH];
+		Bit32s left[GUS_BATCH];
+		Bit32s right[GUS_BATCH];
+
+		while (len) {
+			// Render up to the next wave or ramp boundary in one batch, the
+			// sample that crosses it goes through WaveUpdate/RampUpdate
+			Bitu count = len < GUS_BATCH ? len : GUS_BATCH;
+			Bitu run = WaveRun();
+			if (run < count) count = run;
+			run = RampRun();
+			if (run < count) count = run;
+			if (!count) {
+				Bit32s tmpsamp = bits16 ? GetSample16() : GetSample8();
+				stream[0] += tmpsamp * VolLeft;
+				stream[1] += tmpsamp * VolRight;
 				WaveUpdate();
 				RampUpdate();
+				stream += 2;
+				len--;
+				continue;
 			}
-		}
-		else {
-			for (int i = 0; i < (int)len; i++) {
-				// Get sample
-				Bit32s tmpsamp = GetSample8();
-				// Output stereo sample
-				stream[i << 1] += tmpsamp * VolLeft;
-				stream[(i << 1) + 1] += tmpsamp * VolRight;
-				WaveUpdate();
-				RampUpdate();
+
+			Bit32u step = 0;
+			if (!(WaveCtrl & ( WCTRL_STOP | WCTRL_STOPPED)))
+				step = (WaveCtrl & WCTRL_DECREASING) ? (Bit32u)-(Bit32s)WaveAdd : WaveAdd;
+			if (bits16) {
+				if (interpolate) FetchSamples<true,true>(samples,count,WaveAddr,step);
+				else FetchSamples<true,false>(samples,count,WaveAddr,step);
+			} else {
+				if (interpolate) FetchSamples<false,true>(samples,count,WaveAddr,step);
+				else FetchSamples<false,false>(samples,count,WaveAddr,step);
 			}
+			WaveAddr += step * (Bit32u)count;
+
+			if (RampCtrl & 0x3) {
+				MixConstant(stream,samples,count,VolLeft,VolRight);
+			} else {
+				// Volume changes every sample while ramping
+				Bit32u rampstep = (RampCtrl & 0x40) ? (Bit32u)-(Bit32s)RampAdd : RampAdd;
+				Bit32u vol = RampVol;
+				left[0] = VolLeft;
+				right[0] = VolRight;
+				for (Bitu i = 1; i < count; i++) {
+					vol += rampstep;
+					VolumesAt(vol,left[i],right[i]);
+				}
+				RampVol = vol + rampstep;
+				UpdateVolumes();
+				MixVarying(stream,samples,left,right,count);
+			}
+			stream += count * 2;
+			len -= count;
+		}
+	}
+
+	// Samples and volumes both fit in 16 bits, so pmaddwd against a zero
+	// upper half gives the exact 32-bit product
+	static void MixConstant(Bit32s * stream,const Bit32s * samples,Bitu count,Bit32s volleft,Bit32s volright) {
+		Bitu i = 0;
+#if defined(__SSE2__)
+		const __m128i vol = _mm_setr_epi32(volleft,volright,volleft,volright);
+		for (; i + 4 <= count; i += 4) {
+			__m128i s = _mm_loadu_si128((const __m128i *)&samples[i]);
+			__m128i *out = (__m128i *)&stream[i * 2];
+			__m128i lo = _mm_madd_epi16(_mm_unpacklo_epi32(s,s),vol);
+			__m128i hi = _mm_madd_epi16(_mm_unpackhi_epi32(s,s),vol);
+			_mm_storeu_si128(out,_mm_add_epi32(_mm_loadu_si128(out),lo));
+			_mm_storeu_si128(out + 1,_mm_add_epi32(_mm_loadu_si128(out + 1),hi));
+		}
+#endif
+		for (; i < count; i++) {
+			stream[i * 2] += samples[i] * volleft;
+			stream[i * 2 + 1] += samples[i] * volright;
+		}
+	}
+
+	static void MixVarying(Bit32s * stream,const Bit32s * samples,const Bit32s * left,const Bit32s * right,Bitu count) {
+		Bitu i = 0;
+#if defined(__SSE2__)
+		for (; i + 4 <= count; i += 4) {
+			__m128i s = _mm_loadu_si128((const __m128i *)&samples[i]);
+			__m128i l = _mm_loadu_si128((const __m128i *)&left[i]);
+			__m128i r = _mm_loadu_si128((const __m128i *)&right[i]);
+			__m128i *out = (__m128i *)&stream[i * 2];
+			__m128i lo = _mm_madd_epi16(_mm_unpacklo_epi32(s,s),_mm_unpacklo_epi32(l,r));
+			__m128i hi = _mm_madd_epi16(_mm_unpackhi_epi32(s,s),_mm_unpackhi_epi32(l,r));
+			_mm_storeu_si128(out,_mm_add_epi32(_mm_loadu_si128(out),lo));
+			_mm_storeu_si128(out + 1,_mm_add_epi32(_mm_loadu_si128(out + 1),hi));
+		}
+#endif
+		for (; i < count; i++) {
+			stream[i * 2] += samples[i] * left[i];
+			stream[i * 2 + 1] += samples[i] * right[i];
 		}
 	}
 };
@@ -777,7 +897,14 @@ static void GUS_CallBack(Bitu len) {
 	for (Bitu i = 0; i < myGUS.ActiveChannels; i++) {
 		guschan[i]->generateSamples(buffer[0], len);
 	}
-	for (Bitu i = 0; i < len; i++) {
+	Bitu i = 0;
+#if defined(__SSE2__)
+	for (; i + 2 <= len; i += 2) {
+		__m128i *out = (__m128i *)buffer[i];
+		_mm_storeu_si128(out,_mm_srai_epi32(_mm_loadu_si128(out),VOL_SHIFT));
+	}
+#endif
+	for (; i < len; i++) {
 		buffer[i][0] >>= VOL_SHIFT;
 		buffer[i][1] >>= VOL_SHIFT;
 	}
@@ -785,8 +912,11 @@ static void GUS_CallBack(Bitu len) {
 	CheckVoiceIrq();
 }
 
-// Generate logarithmic to linear volume conversion tables
+// Generate logarithmic to linear volume conversion tables, once per process
 static void MakeTables(void) {
+	static bool doneTables = false;
+	if (doneTables) return;
+	doneTables = true;
 	int i;
 	double out = (double)(1 << 13);
 	for (i=4095;i>=0;i--) {
@@ -18,12 +18,18 @@
 
 
 #include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+#include <algorithm>
 #include "dosbox.h"
 #include "inout.h"
 #include "setup.h"
 #include "cpu.h"
 #include "../src/cpu/lazyflags.h"
 #include "callback.h"
+#include "programs.h"
 
 //#define ENABLE_PORTLOG
 
@@ -285,6 +291,177 @@ void log_io(Bitu width, bool write, Bitu port, Bitu val) {
 #define log_io(W, X, Y, Z)
 #endif
 
+/* Optional per port statistics. Every access is counted and the handler is
+ * timed on the host, the histogram buckets double from 64ns upwards. Only
+ * the dispatch below checks io_stats, the handlers themselves are called
+ * through the same tables as without profiling.
+ */
+#define IO_STAT_PORTS 0x10000
+#define IO_STAT_BUCKETS 12
+#define IO_STAT_SHIFT 6
+
+struct IO_PortStat {
+	Bit64u reads,writes;
+	Bit64u nanos;
+	Bit32u hist[IO_STAT_BUCKETS];
+};
+
+typedef std::chrono::steady_clock IO_StatClock;
+static IO_PortStat * io_stats = 0;
+static IO_StatClock::time_point io_stats_start;
+
+static void IO_StatEnable(bool enable) {
+	if (enable && !io_stats) {
+		io_stats = (IO_PortStat *)calloc(IO_STAT_PORTS,sizeof(IO_PortStat));
+		io_stats_start = IO_StatClock::now();
+	} else if (!enable && io_stats) {
+		free(io_stats);
+		io_stats = 0;
+	}
+}
+
+static void IO_StatReset(void) {
+	if (!io_stats) return;
+	memset(io_stats,0,IO_STAT_PORTS*sizeof(IO_PortStat));
+	io_stats_start = IO_StatClock::now();
+}
+
+static void IO_StatAdd(Bitu port,bool write,IO_StatClock::time_point start) {
+	/* The handler may have run a program that switched profiling off */
+	if (GCC_UNLIKELY(!io_stats)) return;
+	Bit64u nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(IO_StatClock::now()-start).count();
+	IO_PortStat * stat = &io_stats[port & (IO_STAT_PORTS-1)];
+	if (write) stat->writes++;
+	else stat->reads++;
+	stat->nanos += nanos;
+	Bitu bucket = 0;
+	for (nanos >>= IO_STAT_SHIFT;nanos && bucket<IO_STAT_BUCKETS-1;nanos >>= 1) bucket++;
+	stat->hist[bucket]++;
+}
+
+static void IO_StatWrite(Bitu width,Bitu port,Bitu val) {
+	IO_StatClock::time_point start = IO_StatClock::now();
+	io_writehandlers[width][port](port,val,1 << width);
+	IO_StatAdd(port,true,start);
+}
+
+static Bitu IO_StatRead(Bitu width,Bitu port) {
+	IO_StatClock::time_point start = IO_StatClock::now();
+	Bitu retval = io_readhandlers[width][port](port,1 << width);
+	IO_StatAdd(port,false,start);
+	return retval;
+}
+
+static bool IO_StatBusier(Bitu a,Bitu b) {
+	return io_stats[a].reads+io_stats[a].writes > io_stats[b].reads+io_stats[b].writes;
+}
+
+/* Ports with any traffic, busiest first */
+static void IO_StatSorted(std::vector<Bitu> & ports,Bit64u & total,Bit64u & nanos) {
+	total = nanos = 0;
+	for (Bitu port=0;port<IO_STAT_PORTS;port++) {
+		IO_PortStat * stat = &io_stats[port];
+		if (!stat->reads && !stat->writes) continue;
+		ports.push_back(port);
+		total += stat->reads+stat->writes;
+		nanos += stat->nanos;
+	}
+	std::sort(ports.begin(),ports.end(),IO_StatBusier);
+}
+
+static bool IO_StatDump(const char * name) {
+	if (!io_stats) return false;
+	FILE * f = fopen(name,"w");
+	if (!f) return false;
+	std::vector<Bitu> ports;
+	Bit64u total,nanos;
+	IO_StatSorted(ports,total,nanos);
+	double seconds = std::chrono::duration<double>(IO_StatClock::now()-io_stats_start).count();
+	fprintf(f,"# %llu accesses to %u ports in %.1fs, %.1fms in handlers\n",
+		(unsigned long long)total,(unsigned int)ports.size(),seconds,nanos/1e6);
+	fprintf(f,"# port reads writes share%% avg_ns, then calls per bucket <%dns doubling\n",1 << IO_STAT_SHIFT);
+	for (size_t i=0;i<ports.size();i++) {
+		IO_PortStat * stat = &io_stats[ports[i]];
+		Bit64u calls = stat->reads+stat->writes;
+		fprintf(f,"%04X %llu %llu %.2f %llu",(unsigned int)ports[i],
+			(unsigned long long)stat->reads,(unsigned long long)stat->writes,
+			100.0*calls/total,(unsigned long long)(stat->nanos/calls));
+		for (Bitu b=0;b<IO_STAT_BUCKETS;b++) fprintf(f," %u",stat->hist[b]);
+		fprintf(f,"\n");
+	}
+	fclose(f);
+	return true;
+}
+
+class IOSTAT : public Program {
+public:
+	void Run(void) {
+		std::string file;
+		if (cmd->FindExist("/?",false) || cmd->FindExist("-?",false)) {
+			WriteOut("Counts I/O port accesses and times their handlers.\n\n"
+				"IOSTAT [/ON] [/OFF] [/RESET] [/DUMP [file]] [/ALL]\n\n"
+				"  /ON     Start counting.\n"
+				"  /OFF    Stop counting and discard the counters.\n"
+				"  /RESET  Clear the counters.\n"
+				"  /DUMP   Write every port with its time histogram to a host file,\n"
+				"          iostat.txt by default.\n"
+				"  /ALL    List every port instead of the busiest 16.\n");
+			return;
+		}
+		if (cmd->FindExist("/OFF",true)) {
+			IO_StatEnable(false);
+			WriteOut("I/O profiling off.\n");
+			return;
+		}
+		if (cmd->FindExist("/ON",true)) {
+			IO_StatEnable(true);
+			WriteOut("I/O profiling on.\n");
+		}
+		if (!io_stats) {
+			WriteOut("I/O profiling is off, use IOSTAT /ON to start it.\n");
+			return;
+		}
+		if (cmd->FindExist("/RESET",true)) {
+			IO_StatReset();
+			return;
+		}
+		if (cmd->FindString("/DUMP",file,true) || cmd->FindExist("/DUMP",true)) {
+			if (file.empty()) file = "iostat.txt";
+			if (IO_StatDump(file.c_str())) WriteOut("Written to %s\n",file.c_str());
+			else WriteOut("Can't write %s\n",file.c_str());
+			return;
+		}
+		bool all = cmd->FindExist("/ALL",true);
+		std::vector<Bitu> ports;
+		Bit64u total,nanos;
+		IO_StatSorted(ports,total,nanos);
+		if (!total) return;
+		WriteOut("Port     Reads    Writes  Share  Avg ns\n");
+		for (size_t i=0;i<ports.size() && (all || i<16);i++) {
+			IO_PortStat * stat = &io_stats[ports[i]];
+			Bit64u calls = stat->reads+stat->writes;
+			WriteOut("%04X %9llu %9llu %5.1f%% %7llu\n",(unsigned int)ports[i],
+				(unsigned long long)stat->reads,(unsigned long long)stat->writes,
+				100.0*calls/total,(unsigned long long)(stat->nanos/calls));
+		}
+		WriteOut("%llu accesses to %u ports, %.1fms in handlers\n",
+			(unsigned long long)total,(unsigned int)ports.size(),nanos/1e6);
+	}
+};
+
+static void IOSTAT_ProgramStart(Program * * make) {
+	*make=new IOSTAT;
+}
+
+void IO_Change_Config(Section * sec) {
+	IO_StatEnable(static_cast<Section_prop *>(sec)->Get_bool("ioprofile"));
+}
+
+void IOSTAT_Init(Section * sec) {
+	IO_Change_Config(sec);
+	PROGRAMS_MakeFile("IOSTAT.COM",IOSTAT_ProgramStart);
+}
+
 
 void IO_WriteB(Bitu port,Bitu val) {
 	log_io(0, true, port, val);
@@ -318,7 +495,8 @@ void IO_WriteB(Bitu port,Bitu val) {
 	}
 	else {
 		IO_USEC_write_delay();
-		io_writehandlers[0][port](port,val,1);
+		if (GCC_UNLIKELY(io_stats!=0)) IO_StatWrite(0,port,val);
+		else io_writehandlers[0][port](port,val,1);
 	}
 }
 
@@ -354,7 +532,8 @@ void IO_WriteW(Bitu port,Bitu val) {
 	}
 	else {
 		IO_USEC_write_delay();
-		io_writehandlers[1][port](port,val,2);
+		if (GCC_UNLIKELY(io_stats!=0)) IO_StatWrite(1,port,val);
+		else io_writehandlers[1][port](port,val,2);
 	}
 }
 
@@ -388,6 +567,7 @@ void IO_WriteD(Bitu port,Bitu val) {
 		memcpy(&lflags,&old_lflags,sizeof(LazyFlags));
 		cpudecoder=old_cpudecoder;
 	}
+	else if (GCC_UNLIKELY(io_stats!=0)) IO_StatWrite(2,port,val);
 	else io_writehandlers[2][port](port,val,4);
 }
 
@@ -422,7 +602,8 @@ Bitu IO_ReadB(Bitu port) {
 	}
 	else {
 		IO_USEC_read_delay();
-		retval = io_readhandlers[0][port](port,1);
+		if (GCC_UNLIKELY(io_stats!=0)) retval = IO_StatRead(0,port);
+		else retval = io_readhandlers[0][port](port,1);
 	}
 	log_io(0, false, port, retval);
 	return retval;
@@ -458,7 +639,8 @@ Bitu IO_ReadW(Bitu port) {
 	}
 	else {
 		IO_USEC_read_delay();
-		retval = io_readhandlers[1][port](port,2);
+		if (GCC_UNLIKELY(io_stats!=0)) retval = IO_StatRead(1,port);
+		else retval = io_readhandlers[1][port](port,2);
 	}
 	log_io(1, false, port, retval);
 	return retval;
@@ -491,6 +673,8 @@ Bitu IO_ReadD(Bitu port) {
 		reg_dx = old_dx;
 		memcpy(&lflags,&old_lflags,sizeof(LazyFlags));
 		cpudecoder=old_cpudecoder;
+	} else if (GCC_UNLIKELY(io_stats!=0)) {
+		retval = IO_StatRead(2,port);
 	} else {
 		retval = io_readhandlers[2][port](port,4);
 	}
@@ -514,6 +698,7 @@ public:
 static IO* test;
 
 void IO_Destroy(Section*) {
+	IO_StatEnable(false);
 	delete test;
 }
 
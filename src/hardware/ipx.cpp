@@ -605,8 +605,10 @@ static void IPX_ClientLoop(void) {
 	inPacket.channel = UDPChannel;
 
 	// Its amazing how much simpler UDP is than TCP
-	numrecv = SDLNet_UDP_Recv(ipxClientSocket, &inPacket);
-	if(numrecv) receivePacket(inPacket.data, inPacket.len);
+	// Deliver everything that arrived since the last tick, not one packet per ms
+	while((numrecv = SDLNet_UDP_Recv(ipxClientSocket, &inPacket)) > 0) {
+		receivePacket(inPacket.data, inPacket.len);
+	}
 }
 
 
@@ -148,62 +148,64 @@ static void ackClient(IPaddress clientAddr) {
 
 }
 
-static void IPX_ServerLoop() {
-	UDPpacket inPacket;
+static void serverPacket(UDPpacket *inPacket) {
 	IPaddress tmpAddr;
 
 	//char regString[] = "IPX Register\0";
 
 	Bit16u i;
 	Bit32u host;
-	Bits result;
 
-	inPacket.channel = -1;
-	inPacket.data = &inBuffer[0];
-	inPacket.maxlen = IPXBUFFERSIZE;
-
-
-	result = SDLNet_UDP_Recv(ipxServerSocket, &inPacket);
-	if (result != 0) {
-		// Check to see if incoming packet is a registration packet
-		// For this, I just spoofed the echo protocol packet designation 0x02
-		IPXHeader *tmpHeader;
-		tmpHeader = (IPXHeader *)&inBuffer[0];
-	
-		// Check to see if echo packet
-		if(SDLNet_Read16(tmpHeader->dest.socket) == 0x2) {
-			// Null destination node means its a server registration packet
-			if(tmpHeader->dest.addr.byIP.host == 0x0) {
-				UnpackIP(tmpHeader->src.addr.byIP, &tmpAddr);
-				for(i=0;i<SOCKETTABLESIZE;i++) {
-					if(!connBuffer[i].connected) {
-						// Use prefered host IP rather than the reported source IP
-						// It may be better to use the reported source
-						ipconn[i] = inPacket.address;
-
-						connBuffer[i].connected = true;
-						host = ipconn[i].host;
-						LOG_MSG("IPXSERVER: Connect from %d.%d.%d.%d", CONVIP(host));
-						ackClient(inPacket.address);
+	// Check to see if incoming packet is a registration packet
+	// For this, I just spoofed the echo protocol packet designation 0x02
+	IPXHeader *tmpHeader;
+	tmpHeader = (IPXHeader *)&inBuffer[0];
+
+	// Check to see if echo packet
+	if(SDLNet_Read16(tmpHeader->dest.socket) == 0x2) {
+		// Null destination node means its a server registration packet
+		if(tmpHeader->dest.addr.byIP.host == 0x0) {
+			UnpackIP(tmpHeader->src.addr.byIP, &tmpAddr);
+			for(i=0;i<SOCKETTABLESIZE;i++) {
+				if(!connBuffer[i].connected) {
+					// Use prefered host IP rather than the reported source IP
+					// It may be better to use the reported source
+					ipconn[i] = inPacket->address;
+
+					connBuffer[i].connected = true;
+					host = ipconn[i].host;
+					LOG_MSG("IPXSERVER: Connect from %d.%d.%d.%d", CONVIP(host));
+					ackClient(inPacket->address);
+					return;
+				} else {
+					if((ipconn[i].host == tmpAddr.host) && (ipconn[i].port == tmpAddr.port)) {
+
+						LOG_MSG("IPXSERVER: Reconnect from %d.%d.%d.%d", CONVIP(tmpAddr.host));
+						// Update anonymous port number if changed
+						ipconn[i].port = inPacket->address.port;
+						ackClient(inPacket->address);
 						return;
-					} else {
-						if((ipconn[i].host == tmpAddr.host) && (ipconn[i].port == tmpAddr.port)) {
-
-							LOG_MSG("IPXSERVER: Reconnect from %d.%d.%d.%d", CONVIP(tmpAddr.host));
-							// Update anonymous port number if changed
-							ipconn[i].port = inPacket.address.port;
-							ackClient(inPacket.address);
-							return;
-						}
 					}
-					
 				}
+				
 			}
 		}
-
-		// IPX packet is complete.  Now interpret IPX header and send to respective IP address
-		sendIPXPacket((Bit8u *)inPacket.data, inPacket.len);
 	}
+
+	// IPX packet is complete.  Now interpret IPX header and send to respective IP address
+	sendIPXPacket((Bit8u *)inPacket->data, inPacket->len);
+}
+
+static void IPX_ServerLoop() {
+	UDPpacket inPacket;
+
+	inPacket.channel = -1;
+	inPacket.data = &inBuffer[0];
+	inPacket.maxlen = IPXBUFFERSIZE;
+
+	// Forward every datagram queued since the last tick
+	while (SDLNet_UDP_Recv(ipxServerSocket, &inPacket) > 0)
+		serverPacket(&inPacket);
 }
 
 void IPX_StopServer() {
@@ -36,6 +36,9 @@ struct _TCPsocketX {
 	IPaddress remoteAddress;
 	IPaddress localAddress;
 	int sflag;
+	int connecting;
+	int pending;
+	Uint8 sendbuf[SDLNET_TCP_SENDBUF];
 };
 
 Bit32u Netwrapper_GetCapabilities()
@@ -62,6 +65,8 @@ TCPClientSocket::TCPClientSocket(int platformsocket) {
 	// fill the SDL socket manually
 	((struct _TCPsocketX*)nativetcpstruct)->ready=0;
 	((struct _TCPsocketX*)nativetcpstruct)->sflag=0;
+	((struct _TCPsocketX*)nativetcpstruct)->connecting=0;
+	((struct _TCPsocketX*)nativetcpstruct)->pending=0;
 	((struct _TCPsocketX*)nativetcpstruct)->channel=(SOCKET) platformsocket;
 	sockaddr_in		sa;
 	socklen_t		sz;
@@ -98,6 +98,7 @@ Bitu read_p3c0(Bitu /*port*/,Bitu /*iolen*/) {
 }
  
 void write_p3c0(Bitu /*port*/,Bitu val,Bitu iolen) {
+	VGA_RasterWrite();
 	if (!vga.internal.attrindex) {
 		attr(index)=val & 0x1F;
 		vga.internal.attrindex=true;
@@ -66,6 +66,7 @@ static void VGA_DAC_UpdateColor( Bitu index ) {
 }
 
 static void write_p3c6(Bitu port,Bitu val,Bitu iolen) {
+	VGA_RasterWrite();
 	if ( vga.dac.pel_mask != val ) {
 		LOG(LOG_VGAMISC,LOG_NORMAL)("VGA:DCA:Pel Mask set to %X", val);
 		vga.dac.pel_mask = val;
@@ -104,6 +105,7 @@ static Bitu read_p3c8(Bitu port, Bitu iolen){
 }
 
 static void write_p3c9(Bitu port,Bitu val,Bitu iolen) {
+	VGA_RasterWrite();
 	val&=0x3f;
 	switch (vga.dac.pel_index) {
 	case 0:
@@ -118,19 +118,23 @@ static Bit8u * VGA_Draw_4BPP_Line_Double(Bitu vidstart, Bitu line) {
 static Bit8u * VGA_Draw_Changes_Line(Bitu vidstart, Bitu /*line*/) {
     Bitu checkMask = vga.changes.checkMask;
     Bit8u *map = vga.changes.map;
-    Bitu start = vidstart >> VGA_CHANGE_SHIFT;
-    Bitu end = (vidstart + vga.draw.line_length) >> VGA_CHANGE_SHIFT;
+    Bitu offset = vidstart & vga.draw.linear_mask;
+    Bitu start = offset >> VGA_CHANGE_SHIFT;
+    Bitu end = (offset + vga.draw.line_length - 1) >> VGA_CHANGE_SHIFT;
+    vga.changes.drawn++;
+    // Lines wrapping around the end of video memory are always drawn
+    if (end > vga.changes.mapMask || (vga.draw.linear_mask - offset < vga.draw.line_length)) {
+        memcpy(TempLine, &vga.draw.linear_base[offset], vga.draw.linear_mask + 1 - offset);
+        memcpy(&TempLine[vga.draw.linear_mask + 1 - offset], vga.draw.linear_base,
+               vga.draw.line_length - (vga.draw.linear_mask + 1 - offset));
+        return TempLine;
+    }
     for (; start <= end; ++start) {
         if (map[start] & checkMask) {
-            Bitu offset = vidstart & vga.draw.linear_mask;
-            Bit8u *ret = &vga.draw.linear_base[offset];
-            if (vga.draw.linear_mask - offset < vga.draw.line_length) {
-                memcpy(TempLine, ret, vga.draw.line_length);
-                return TempLine;
-            }
-            return ret;
+            return &vga.draw.linear_base[offset];
         }
     }
+    vga.changes.skipped++;
     return nullptr;
 }
 #endif
@@ -443,15 +447,31 @@ static Bit8u * VGA_TEXT_Xlat16_Draw_Line(Bitu vidstart, Bitu line) {
 }
 
 #ifdef VGA_KEEP_CHANGES
+static inline void VGA_ClearChanges(Bitu start, Bitu end) {
+    Bit32u clearMask = vga.changes.clearMask;
+    Bit32u *clear = (Bit32u *)&vga.changes.map[start & ~3];
+    for (Bitu total = (end - (start & ~3) + 4) >> 2; total > 0; --total) {
+        *clear++ &= clearMask;
+    }
+}
+
+// Drop the bits checked during this frame for the memory that was displayed
 static inline void VGA_ChangesEnd() {
     if (vga.changes.active) {
-        Bitu end = vga.draw.address >> VGA_CHANGE_SHIFT;
-        Bitu total = 4 + end - vga.changes.start;
-        Bit32u clearMask = vga.changes.clearMask;
-        total >>= 2;
-        Bit32u *clear = (Bit32u *)&vga.changes.map[vga.changes.start & ~3];
-        while (total--) {
-            *clear++ &= clearMask;
+        Bitu mapMask = vga.changes.mapMask;
+        if (vga.draw.address - vga.changes.start > vga.draw.linear_mask) {
+            VGA_ClearChanges(0, mapMask);
+            return;
+        }
+        Bitu start = ((vga.changes.start & vga.draw.linear_mask) >> VGA_CHANGE_SHIFT) & mapMask;
+        Bitu end = (((vga.draw.address - 1) & vga.draw.linear_mask) >> VGA_CHANGE_SHIFT) & mapMask;
+        if (vga.draw.address == vga.changes.start) {
+            return;
+        } else if (start <= end) {
+            VGA_ClearChanges(start, end);
+        } else {
+            VGA_ClearChanges(start, mapMask);
+            VGA_ClearChanges(0, end);
         }
     }
 }
@@ -471,7 +491,7 @@ static void VGA_ProcessSplit() {
 }
 
 static Bit8u bg_color_index = 0;
-static void VGA_DrawSingleLine(Bitu /*blah*/) {
+static void VGA_DrawOneLine() {
     if (vga.attr.disabled) {
         if (vga.draw.bpp == 8) {
             memset(TempLine, bg_color_index, sizeof(TempLine));
@@ -496,14 +516,9 @@ static void VGA_DrawSingleLine(Bitu /*blah*/) {
     if (vga.draw.split_line == vga.draw.lines_done) {
         VGA_ProcessSplit();
     }
-    if (vga.draw.lines_done < vga.draw.lines_total) {
-        PIC_AddEvent(VGA_DrawSingleLine, (float)vga.draw.delay.htotal);
-    } else {
-        RENDER_EndUpdate(false);
-    }
 }
 
-static void VGA_DrawEGASingleLine(Bitu /*blah*/) {
+static void VGA_DrawOneEGALine() {
     if (vga.attr.disabled) {
         memset(TempLine, 0, sizeof(TempLine));
         RENDER_DrawLine(TempLine);
@@ -521,12 +536,67 @@ static void VGA_DrawEGASingleLine(Bitu /*blah*/) {
     if (vga.draw.split_line == vga.draw.lines_done) {
         VGA_ProcessSplit();
     }
+}
+
+#ifdef VGA_BATCH_LINES
+static void VGA_DrawLines(Bitu count) {
+    if (count > vga.draw.lines_total - vga.draw.lines_done) {
+        count = vga.draw.lines_total - vga.draw.lines_done;
+    }
+    if (vga.draw.mode == EGALINE) {
+        while (count--) {
+            VGA_DrawOneEGALine();
+        }
+    } else {
+        while (count--) {
+            VGA_DrawOneLine();
+        }
+    }
+    if (vga.draw.lines_done >= vga.draw.lines_total) {
+        vga.draw.batch_pending = false;
+        RENDER_EndUpdate(false);
+    }
+}
+
+// Scheduled at the time of the last line, draws whatever no register write
+// forced out earlier
+static void VGA_DrawLineBatch(Bitu /*val*/) {
+    if (vga.draw.batch_pending) {
+        VGA_DrawLines(vga.draw.lines_total - vga.draw.lines_done);
+    }
+}
+
+// Draw the lines the beam has passed, so a register write only affects the
+// lines after it like it would with an event per line
+void VGA_DrawPendingLines() {
+    double passed = PIC_FullIndex() - vga.draw.delay.linestart;
+    if (passed < 0) {
+        return;
+    }
+    Bitu due = (Bitu)(passed / vga.draw.delay.htotal) + 1;
+    if (due > vga.draw.lines_done) {
+        VGA_DrawLines(due - vga.draw.lines_done);
+    }
+}
+#else
+static void VGA_DrawSingleLine(Bitu /*blah*/) {
+    VGA_DrawOneLine();
+    if (vga.draw.lines_done < vga.draw.lines_total) {
+        PIC_AddEvent(VGA_DrawSingleLine, (float)vga.draw.delay.htotal);
+    } else {
+        RENDER_EndUpdate(false);
+    }
+}
+
+static void VGA_DrawEGASingleLine(Bitu /*blah*/) {
+    VGA_DrawOneEGALine();
     if (vga.draw.lines_done < vga.draw.lines_total) {
         PIC_AddEvent(VGA_DrawEGASingleLine, (float)vga.draw.delay.htotal);
     } else {
         RENDER_EndUpdate(false);
     }
 }
+#endif
 
 static void VGA_DrawPart(Bitu lines) {
     while (lines--) {
@@ -544,7 +614,7 @@ static void VGA_DrawPart(Bitu lines) {
 #endif
             VGA_ProcessSplit();
 #ifdef VGA_KEEP_CHANGES
-            vga.changes.start = vga.draw.address >> VGA_CHANGE_SHIFT;
+            vga.changes.start = vga.draw.address;
 #endif
         }
     }
@@ -568,21 +638,59 @@ void VGA_SetBlinking(Bitu enabled) {
 }
 
 #ifdef VGA_KEEP_CHANGES
+// Only modes where every write to the displayed memory passes a handler that
+// marks the change map, or a page that handler mapped writable this frame.
+static inline bool VGA_ChangesTracked() {
+    if (vga.draw.mode != PART || (VGA_DrawLine != VGA_Draw_Linear_Line && VGA_DrawLine != VGA_Draw_Changes_Line)) {
+        return false;
+    }
+    switch (vga.mode) {
+    case M_EGA:
+    case M_LIN4:
+        return true;
+    case M_VGA:
+        return vga.draw.linear_base == vga.fastmem || !vga.config.chained;
+#ifdef VGA_LFB_MAPPED
+    case M_LIN8:
+    case M_LIN15:
+    case M_LIN16:
+    case M_LIN32:
+        return vga.draw.linear_base == vga.mem.linear;
+#endif
+    default:
+        return false;
+    }
+}
+
 static inline void VGA_ChangesStart() {
-    vga.changes.start = vga.draw.address >> VGA_CHANGE_SHIFT;
+    // Pages written last frame take a tracked write again before they are mapped
+    VGA_ProtectChanges();
+    if (!VGA_ChangesTracked()) {
+        if (VGA_DrawLine == VGA_Draw_Changes_Line) {
+            VGA_DrawLine = VGA_Draw_Linear_Line;
+        }
+        vga.changes.active = false;
+        return;
+    }
+    vga.changes.start = vga.draw.address;
     vga.changes.last = vga.changes.start;
-    if (vga.changes.lastAddress != vga.draw.address) {
+    // An aborted frame never cleared its bits, redraw everything once
+    if (!vga.changes.active || vga.draw.parts_left || vga.changes.lastAddress != vga.draw.address ||
+        vga.changes.lastLinearMask != vga.draw.linear_mask || vga.changes.lastLinearBase != vga.draw.linear_base) {
         VGA_DrawLine = VGA_Draw_Linear_Line;
         vga.changes.lastAddress = vga.draw.address;
+        vga.changes.lastLinearMask = vga.draw.linear_mask;
+        vga.changes.lastLinearBase = vga.draw.linear_base;
     } else if (render.fullFrame) {
         VGA_DrawLine = VGA_Draw_Linear_Line;
     } else {
         VGA_DrawLine = VGA_Draw_Changes_Line;
     }
     vga.changes.active = true;
-    vga.changes.checkMask = vga.changes.writeMask;
     vga.changes.clearMask = ~(0x01010101 << (vga.changes.frame & 7));
     vga.changes.frame++;
+    // Also check the new bit, lines written this frame before the beam got there
+    vga.changes.checkMask = vga.changes.writeMask | (1 << (vga.changes.frame & 7));
     vga.changes.writeMask = 1 << (vga.changes.frame & 7);
 }
 #endif
@@ -610,6 +718,7 @@ static void VGA_DisplayStartLatch(Bitu /*val*/) {
 }
 
 static void VGA_PanningLatch(Bitu /*val*/) {
+    VGA_RasterWrite();
     vga.draw.panning = vga.config.pel_panning;
 }
 
@@ -730,6 +839,17 @@ static void VGA_VerticalTimer(Bitu /*val*/) {
         break;
     case DRAWLINE:
     case EGALINE:
+#ifdef VGA_BATCH_LINES
+        if (vga.draw.lines_done < vga.draw.lines_total) {
+            PIC_RemoveEvents(VGA_DrawLineBatch);
+            RENDER_EndUpdate(true);
+        }
+        vga.draw.lines_done = 0;
+        vga.draw.delay.linestart = vga.draw.delay.framestart + vga.draw.delay.htotal / 4.0 + draw_skip;
+        vga.draw.batch_pending = true;
+        PIC_AddEvent(VGA_DrawLineBatch, (float)(vga.draw.delay.htotal / 4.0 + draw_skip +
+                                                 vga.draw.delay.htotal * (vga.draw.lines_total - 1)));
+#else
         if (vga.draw.lines_done < vga.draw.lines_total) {
             if (vga.draw.mode == EGALINE) {
                 PIC_RemoveEvents(VGA_DrawEGASingleLine);
@@ -741,6 +861,7 @@ static void VGA_VerticalTimer(Bitu /*val*/) {
         vga.draw.lines_done = 0;
         PIC_AddEvent(vga.draw.mode == EGALINE ? VGA_DrawEGASingleLine : VGA_DrawSingleLine,
                      (float)(vga.draw.delay.htotal / 4.0 + draw_skip));
+#endif
         break;
     }
 }
@@ -1123,8 +1244,13 @@ void VGA_SetupDrawing(Bitu /*val*/) {
 
 void VGA_KillDrawing() {
     PIC_RemoveEvents(VGA_DrawPart);
+#ifdef VGA_BATCH_LINES
+    PIC_RemoveEvents(VGA_DrawLineBatch);
+    vga.draw.batch_pending = false;
+#else
     PIC_RemoveEvents(VGA_DrawSingleLine);
     PIC_RemoveEvents(VGA_DrawEGASingleLine);
+#endif
     vga.draw.parts_left = 0;
     vga.draw.lines_done = ~0;
     if (!vga.draw.vga_override) {
@@ -47,10 +47,13 @@
 
 
 #ifdef VGA_KEEP_CHANGES
-#define MEM_CHANGED( _MEM ) vga.changes.map[ (_MEM) >> VGA_CHANGE_SHIFT ] |= vga.changes.writeMask;
+#define MEM_CHANGED( _MEM ) vga.changes.map[ ((_MEM) >> VGA_CHANGE_SHIFT) & vga.changes.mapMask ] |= vga.changes.writeMask;
 //#define MEM_CHANGED( _MEM ) vga.changes.map[ (_MEM) >> VGA_CHANGE_SHIFT ] = 1;
+// Accesses are smaller than a change block, so marking both ends covers them
+#define MEM_CHANGED_RANGE( _MEM, _LEN ) { MEM_CHANGED( _MEM ); MEM_CHANGED( (_MEM) + (_LEN) - 1 ); }
 #else
 #define MEM_CHANGED( _MEM ) 
+#define MEM_CHANGED_RANGE( _MEM, _LEN )
 #endif
 
 #define TANDY_VIDBASE(_X_)  &MemBase[ 0x80000 + (_X_)]
@@ -222,7 +225,7 @@ public:
 		addr = PAGING_GetPhysicalAddress(addr) & vgapages.mask;
 		addr += vga.svga.bank_write_full;
 		addr = CHECKED(addr);
-		MEM_CHANGED( addr << 3);
+		MEM_CHANGED_RANGE( addr << 3, 16 );
 		writeHandler(addr+0,(Bit8u)(val >> 0));
 		writeHandler(addr+1,(Bit8u)(val >> 8));
 	}
@@ -230,7 +233,7 @@ public:
 		addr = PAGING_GetPhysicalAddress(addr) & vgapages.mask;
 		addr += vga.svga.bank_write_full;
 		addr = CHECKED(addr);
-		MEM_CHANGED( addr << 3);
+		MEM_CHANGED_RANGE( addr << 3, 32 );
 		writeHandler(addr+0,(Bit8u)(val >> 0));
 		writeHandler(addr+1,(Bit8u)(val >> 8));
 		writeHandler(addr+2,(Bit8u)(val >> 16));
@@ -306,7 +309,7 @@ public:
 		addr = PAGING_GetPhysicalAddress(addr) & vgapages.mask;
 		addr += vga.svga.bank_write_full;
 		addr = CHECKED2(addr);
-		MEM_CHANGED( addr << 3);
+		MEM_CHANGED_RANGE( addr << 3, 16 );
 		writeHandler<true>(addr+0,(Bit8u)(val >> 0));
 		writeHandler<true>(addr+1,(Bit8u)(val >> 8));
 	}
@@ -314,7 +317,7 @@ public:
 		addr = PAGING_GetPhysicalAddress(addr) & vgapages.mask;
 		addr += vga.svga.bank_write_full;
 		addr = CHECKED2(addr);
-		MEM_CHANGED( addr << 3);
+		MEM_CHANGED_RANGE( addr << 3, 32 );
 		writeHandler<true>(addr+0,(Bit8u)(val >> 0));
 		writeHandler<true>(addr+1,(Bit8u)(val >> 8));
 		writeHandler<true>(addr+2,(Bit8u)(val >> 16));
@@ -387,7 +390,7 @@ public:
 		addr = PAGING_GetPhysicalAddress(addr) & vgapages.mask;
 		addr += vga.svga.bank_write_full;
 		addr = CHECKED(addr);
-		MEM_CHANGED( addr );
+		MEM_CHANGED_RANGE( addr, 2 );
 //		MEM_CHANGED( addr + 1);
 		if (GCC_UNLIKELY(addr & 1)) {
 			writeHandler<Bit8u>( addr+0, val >> 0 );
@@ -401,7 +404,7 @@ public:
 		addr = PAGING_GetPhysicalAddress(addr) & vgapages.mask;
 		addr += vga.svga.bank_write_full;
 		addr = CHECKED(addr);
-		MEM_CHANGED( addr );
+		MEM_CHANGED_RANGE( addr, 4 );
 //		MEM_CHANGED( addr + 3);
 		if (GCC_UNLIKELY(addr & 3)) {
 			writeHandler<Bit8u>( addr+0, val >> 0 );
@@ -442,7 +445,7 @@ public:
 		addr = PAGING_GetPhysicalAddress(addr) & vgapages.mask;
 		addr += vga.svga.bank_write_full;
 		addr = CHECKED2(addr);
-		MEM_CHANGED( addr << 2);
+		MEM_CHANGED_RANGE( addr << 2, 8 );
 		writeHandler(addr+0,(Bit8u)(val >> 0));
 		writeHandler(addr+1,(Bit8u)(val >> 8));
 	}
@@ -450,7 +453,7 @@ public:
 		addr = PAGING_GetPhysicalAddress(addr) & vgapages.mask;
 		addr += vga.svga.bank_write_full;
 		addr = CHECKED2(addr);
-		MEM_CHANGED( addr << 2);
+		MEM_CHANGED_RANGE( addr << 2, 16 );
 		writeHandler(addr+0,(Bit8u)(val >> 0));
 		writeHandler(addr+1,(Bit8u)(val >> 8));
 		writeHandler(addr+2,(Bit8u)(val >> 16));
@@ -507,10 +510,50 @@ public:
 	}
 };
 
+#if defined(VGA_KEEP_CHANGES) && defined(VGA_LFB_MAPPED)
+/* The tracking handlers leave pages write protected. The first write to a
+ * page in a frame marks all of it and opens the write pointer of its TLB
+ * entry, so the rest of the frame runs at host memory speed until
+ * VGA_ProtectChanges closes it again. The entry stays linked throughout. */
+static void VGA_MapChanged(PageHandler * handler,PhysPt lin_addr,PhysPt phys_addr,Bitu offset) {
+	if (vga.changes.mappedUsed >= VGA_CHANGE_PAGES) return;
+	Bitu start = offset - (phys_addr & 4095);
+	for (Bitu i = 0; i < 4096; i += 1 << VGA_CHANGE_SHIFT) MEM_CHANGED( CHECKED3(start + i) );
+	MEM_CHANGED( CHECKED3(start + 4095) );
+	if (!PAGING_SetPageWrite(lin_addr >> 12, handler, handler->GetHostWritePt(phys_addr >> 12))) return;
+	vga.changes.mapped[vga.changes.mappedUsed] = lin_addr >> 12;
+	vga.changes.mappedHandler[vga.changes.mappedUsed++] = handler;
+}
+#else
+static inline void VGA_MapChanged(PageHandler * /*handler*/,PhysPt /*lin_addr*/,PhysPt /*phys_addr*/,Bitu /*offset*/) {
+}
+#endif
+
+void VGA_ProtectChanges(void) {
+#if defined(VGA_KEEP_CHANGES) && defined(VGA_LFB_MAPPED)
+	// Entries relinked or flushed since then belong to someone else, leave those
+	for (Bitu i = 0; i < vga.changes.mappedUsed; i++)
+		PAGING_SetPageWrite(vga.changes.mapped[i], vga.changes.mappedHandler[i], NULL);
+	vga.changes.mappedUsed = 0;
+#endif
+}
+
 class VGA_Changes_Handler : public PageHandler {
 public:
 	VGA_Changes_Handler() {
+#ifdef VGA_LFB_MAPPED
+		flags=PFLAG_READABLE|PFLAG_NOCODE;
+#else
 		flags=PFLAG_NOCODE;
+#endif
+	}
+	HostPt GetHostReadPt(Bitu phys_page) {
+		phys_page-=vgapages.base;
+		return &vga.mem.linear[CHECKED3(vga.svga.bank_read_full+phys_page*4096)];
+	}
+	HostPt GetHostWritePt(Bitu phys_page) {
+		phys_page-=vgapages.base;
+		return &vga.mem.linear[CHECKED3(vga.svga.bank_write_full+phys_page*4096)];
 	}
 	Bitu readb(PhysPt addr) {
 		addr = PAGING_GetPhysicalAddress(addr) & vgapages.mask;
@@ -531,25 +574,25 @@ public:
 		return hostRead<Bit32u>( &vga.mem.linear[addr] );
 	}
 	void writeb(PhysPt addr,Bitu val) {
-		addr = PAGING_GetPhysicalAddress(addr) & vgapages.mask;
-		addr += vga.svga.bank_write_full;
-		addr = CHECKED(addr);
-		MEM_CHANGED( addr );
-		hostWrite<Bit8u>( &vga.mem.linear[addr], val );
+		PhysPt phys = PAGING_GetPhysicalAddress(addr);
+		Bitu offset = CHECKED((phys & vgapages.mask) + vga.svga.bank_write_full);
+		MEM_CHANGED( offset );
+		hostWrite<Bit8u>( &vga.mem.linear[offset], val );
+		VGA_MapChanged( this, addr, phys, offset );
 	}
 	void writew(PhysPt addr,Bitu val) {
-		addr = PAGING_GetPhysicalAddress(addr) & vgapages.mask;
-		addr += vga.svga.bank_write_full;
-		addr = CHECKED(addr);
-		MEM_CHANGED( addr );
-		hostWrite<Bit16u>( &vga.mem.linear[addr], val );
+		PhysPt phys = PAGING_GetPhysicalAddress(addr);
+		Bitu offset = CHECKED((phys & vgapages.mask) + vga.svga.bank_write_full);
+		MEM_CHANGED_RANGE( offset, 2 );
+		hostWrite<Bit16u>( &vga.mem.linear[offset], val );
+		VGA_MapChanged( this, addr, phys, offset );
 	}
 	void writed(PhysPt addr,Bitu val) {
-		addr = PAGING_GetPhysicalAddress(addr) & vgapages.mask;
-		addr += vga.svga.bank_write_full;
-		addr = CHECKED(addr);
-		MEM_CHANGED( addr );	
-		hostWrite<Bit32u>( &vga.mem.linear[addr], val );
+		PhysPt phys = PAGING_GetPhysicalAddress(addr);
+		Bitu offset = CHECKED((phys & vgapages.mask) + vga.svga.bank_write_full);
+		MEM_CHANGED_RANGE( offset, 4 );
+		hostWrite<Bit32u>( &vga.mem.linear[offset], val );
+		VGA_MapChanged( this, addr, phys, offset );
 	}
 };
 
@@ -567,14 +610,14 @@ public:
 	void writew(PhysPt addr,Bitu val) {
 		addr = vga.svga.bank_write_full + (PAGING_GetPhysicalAddress(addr) & 0xffff);
 		addr = CHECKED4(addr);
-		MEM_CHANGED( addr << 3 );
+		MEM_CHANGED_RANGE( addr << 3, 16 );
 		writeHandler<false>(addr+0,(Bit8u)(val >> 0));
 		writeHandler<false>(addr+1,(Bit8u)(val >> 8));
 	}
 	void writed(PhysPt addr,Bitu val) {
 		addr = vga.svga.bank_write_full + (PAGING_GetPhysicalAddress(addr) & 0xffff);
 		addr = CHECKED4(addr);
-		MEM_CHANGED( addr << 3 );
+		MEM_CHANGED_RANGE( addr << 3, 32 );
 		writeHandler<false>(addr+0,(Bit8u)(val >> 0));
 		writeHandler<false>(addr+1,(Bit8u)(val >> 8));
 		writeHandler<false>(addr+2,(Bit8u)(val >> 16));
@@ -607,7 +650,18 @@ public:
 class VGA_LFBChanges_Handler : public PageHandler {
 public:
 	VGA_LFBChanges_Handler() {
+#ifdef VGA_LFB_MAPPED
+		flags=PFLAG_READABLE|PFLAG_NOCODE;
+#else
 		flags=PFLAG_NOCODE;
+#endif
+	}
+	HostPt GetHostReadPt( Bitu phys_page ) {
+		phys_page -= vga.lfb.page;
+		return &vga.mem.linear[CHECKED3(phys_page * 4096)];
+	}
+	HostPt GetHostWritePt( Bitu phys_page ) {
+		return GetHostReadPt( phys_page );
 	}
 	Bitu readb(PhysPt addr) {
 		addr = PAGING_GetPhysicalAddress(addr) - vga.lfb.addr;
@@ -625,22 +679,25 @@ public:
 		return hostRead<Bit32u>( &vga.mem.linear[addr] );
 	}
 	void writeb(PhysPt addr,Bitu val) {
-		addr = PAGING_GetPhysicalAddress(addr) - vga.lfb.addr;
-		addr = CHECKED(addr);
-		hostWrite<Bit8u>( &vga.mem.linear[addr], val );
-		MEM_CHANGED( addr );
+		PhysPt phys = PAGING_GetPhysicalAddress(addr);
+		Bitu offset = CHECKED(phys - vga.lfb.addr);
+		hostWrite<Bit8u>( &vga.mem.linear[offset], val );
+		MEM_CHANGED( offset );
+		VGA_MapChanged( this, addr, phys, offset );
 	}
 	void writew(PhysPt addr,Bitu val) {
-		addr = PAGING_GetPhysicalAddress(addr) - vga.lfb.addr;
-		addr = CHECKED(addr);
-		hostWrite<Bit16u>( &vga.mem.linear[addr], val );
-		MEM_CHANGED( addr );
+		PhysPt phys = PAGING_GetPhysicalAddress(addr);
+		Bitu offset = CHECKED(phys - vga.lfb.addr);
+		hostWrite<Bit16u>( &vga.mem.linear[offset], val );
+		MEM_CHANGED_RANGE( offset, 2 );
+		VGA_MapChanged( this, addr, phys, offset );
 	}
 	void writed(PhysPt addr,Bitu val) {
-		addr = PAGING_GetPhysicalAddress(addr) - vga.lfb.addr;
-		addr = CHECKED(addr);
-		hostWrite<Bit32u>( &vga.mem.linear[addr], val );
-		MEM_CHANGED( addr );
+		PhysPt phys = PAGING_GetPhysicalAddress(addr);
+		Bitu offset = CHECKED(phys - vga.lfb.addr);
+		hostWrite<Bit32u>( &vga.mem.linear[offset], val );
+		MEM_CHANGED_RANGE( offset, 4 );
+		VGA_MapChanged( this, addr, phys, offset );
 	}
 };
 
@@ -850,7 +907,7 @@ void VGA_SetupHandlers(void) {
 	case M_LIN15:
 	case M_LIN16:
 	case M_LIN32:
-#ifdef VGA_LFB_MAPPED
+#if defined(VGA_LFB_MAPPED) && !defined(VGA_KEEP_CHANGES)
 		newHandler = &vgaph.map;
 #else
 		newHandler = &vgaph.changes;
@@ -862,7 +919,7 @@ void VGA_SetupHandlers(void) {
 			if(vga.config.compatible_chain4)
 				newHandler = &vgaph.cvga;
 			else 
-#ifdef VGA_LFB_MAPPED
+#if defined(VGA_LFB_MAPPED) && !defined(VGA_KEEP_CHANGES)
 				newHandler = &vgaph.map;
 #else
 				newHandler = &vgaph.changes;
@@ -926,13 +983,15 @@ void VGA_SetupHandlers(void) {
 	if(svgaCard == SVGA_S3Trio && (vga.s3.ext_mem_ctrl & 0x10))
 		MEM_SetPageHandler(VGA_PAGE_A0, 16, &vgaph.mmio);
 range_done:
-	PAGING_ClearTLB();
+	/* Without paging only the linear pages of the window map onto it */
+	if (PAGING_Enabled()) PAGING_ClearTLB();
+	else PAGING_InvalidatePages(VGA_PAGE_A0,32);
 }
 
 void VGA_StartUpdateLFB(void) {
 	vga.lfb.page = vga.s3.la_window << 4;
 	vga.lfb.addr = vga.s3.la_window << 16;
-#ifdef VGA_LFB_MAPPED
+#if defined(VGA_LFB_MAPPED) && !defined(VGA_KEEP_CHANGES)
 	vga.lfb.handler = &vgaph.lfb;
 #else
 	vga.lfb.handler = &vgaph.lfbchanges;
@@ -944,6 +1003,8 @@ static void VGA_Memory_ShutDown(Section * /*sec*/) {
 	delete[] vga.mem.linear_orgptr;
 	delete[] vga.fastmem_orgptr;
 #ifdef VGA_KEEP_CHANGES
+	if (vga.changes.drawn)
+		LOG_MSG("VGA: skipped %u of %u tracked scanlines",vga.changes.skipped,vga.changes.drawn);
 	delete[] vga.changes.map;
 #endif
 }
@@ -970,9 +1031,13 @@ void VGA_SetupMemory(Section* sec) {
 
 #ifdef VGA_KEEP_CHANGES
 	memset( &vga.changes, 0, sizeof( vga.changes ));
-	int changesMapSize = (vga.vmemsize >> VGA_CHANGE_SHIFT) + 32;
-	vga.changes.map = new Bit8u[changesMapSize];
-	memset(vga.changes.map, 0, changesMapSize);
+	// Cover fastmem, a power of 2 so stray planar offsets can be masked
+	Bit32u changesMapSize = 1;
+	while (changesMapSize < ((vga.vmemsize << 1) >> VGA_CHANGE_SHIFT)) changesMapSize <<= 1;
+	vga.changes.mapMask = changesMapSize - 1;
+	vga.changes.map = new Bit8u[changesMapSize + 32];
+	memset(vga.changes.map, 0, changesMapSize + 32);
+	vga.changes.writeMask = 1;
 #endif
 	vga.svga.bank_read = vga.svga.bank_write = 0;
 	vga.svga.bank_read_full = vga.svga.bank_write_full = 0;
@@ -36,6 +36,7 @@ static Bitu read_crtc_index_other(Bitu /*port*/,Bitu /*iolen*/) {
 }
 
 static void write_crtc_data_other(Bitu /*port*/,Bitu val,Bitu /*iolen*/) {
+	VGA_RasterWrite();
 	switch (vga.other.index) {
 	case 0x00:		//Horizontal total
 		if (vga.other.htotal ^ val) VGA_StartResize();
@@ -385,6 +386,7 @@ static void write_cga_color_select(Bitu val) {
 }
 
 static void write_cga(Bitu port,Bitu val,Bitu /*iolen*/) {
+	VGA_RasterWrite();
 	switch (port) {
 	case 0x3d8:
 		vga.tandy.mode_control=(Bit8u)val;
@@ -585,6 +587,7 @@ static void write_tandy_reg(Bit8u val) {
 }
 
 static void write_tandy(Bitu port,Bitu val,Bitu /*iolen*/) {
+	VGA_RasterWrite();
 	switch (port) {
 	case 0x3d8:
 		val &= 0x3f; // only bits 0-6 are used
@@ -632,6 +635,7 @@ static void write_tandy(Bitu port,Bitu val,Bitu /*iolen*/) {
 }
 
 static void write_pcjr(Bitu port,Bitu val,Bitu /*iolen*/) {
+	VGA_RasterWrite();
 	switch (port) {
 	case 0x3da:
 		if (vga.tandy.pcjr_flipflop) write_tandy_reg((Bit8u)val);
@@ -709,6 +713,7 @@ void Herc_Palette(void) {
 }
 
 static void write_hercules(Bitu port,Bitu val,Bitu /*iolen*/) {
+	VGA_RasterWrite();
 	switch (port) {
 	case 0x3b8: {
 		// the protected bits can always be cleared but only be set if the 
@@ -800,7 +805,7 @@ void VGA_SetupOther(void) {
 	vga.tandy.line_shift = 13;
 
 	if (machine==MCH_CGA || IS_TANDY_ARCH) {
-		extern Bit8u int10_font_08[256 * 8];
+		extern const Bit8u int10_font_08[256 * 8];
 		for (i=0;i<256;i++)	memcpy(&vga.draw.font[i*32],&int10_font_08[i*8],8);
 		vga.draw.font_tables[0]=vga.draw.font_tables[1]=vga.draw.font;
 	}
@@ -809,7 +814,7 @@ void VGA_SetupOther(void) {
 		IO_RegisterWriteHandler(0x3dc,write_lightpen,IO_MB);
 	}
 	if (machine==MCH_HERC) {
-		extern Bit8u int10_font_14[256 * 14];
+		extern const Bit8u int10_font_14[256 * 14];
 		for (i=0;i<256;i++)	memcpy(&vga.draw.font[i*32],&int10_font_14[i*14],14);
 		vga.draw.font_tables[0]=vga.draw.font_tables[1]=vga.draw.font;
 		MAPPER_AddHandler(CycleHercPal,MK_f11,0,"hercpal","Herc Pal");
@@ -127,6 +127,13 @@ Bitu XGA_Read_Multifunc() {
 }
 
 
+// The accelerator writes video memory directly, mark it for the line skipping
+static inline void XGA_Changed(Bitu offset) {
+#ifdef VGA_KEEP_CHANGES
+	vga.changes.map[(offset >> VGA_CHANGE_SHIFT) & vga.changes.mapMask] |= vga.changes.writeMask;
+#endif
+}
+
 void XGA_DrawPoint(Bitu x, Bitu y, Bitu c) {
 	if(!(xga.curcommand & 0x1)) return;
 	if(!(xga.curcommand & 0x10)) return;
@@ -144,18 +151,22 @@ void XGA_DrawPoint(Bitu x, Bitu y, Bitu c) {
 		case M_LIN8:
 			if (GCC_UNLIKELY(memaddr >= vga.vmemsize)) break;
 			vga.mem.linear[memaddr] = c;
+			XGA_Changed(memaddr);
 			break;
 		case M_LIN15:
 			if (GCC_UNLIKELY(memaddr*2 >= vga.vmemsize)) break;
 			((Bit16u*)(vga.mem.linear))[memaddr] = (Bit16u)(c&0x7fff);
+			XGA_Changed(memaddr*2);
 			break;
 		case M_LIN16:
 			if (GCC_UNLIKELY(memaddr*2 >= vga.vmemsize)) break;
 			((Bit16u*)(vga.mem.linear))[memaddr] = (Bit16u)(c&0xffff);
+			XGA_Changed(memaddr*2);
 			break;
 		case M_LIN32:
 			if (GCC_UNLIKELY(memaddr*4 >= vga.vmemsize)) break;
 			((Bit32u*)(vga.mem.linear))[memaddr] = c;
+			XGA_Changed(memaddr*4);
 			break;
 		default:
 			break;
@@ -26,6 +26,7 @@
 #include "dos_inc.h" /* for Drives[] */
 #include "../dos/drives.h"
 #include "mapper.h"
+#include "compressed_image.h"
 
 #define MAX_DISK_IMAGES 4
 
@@ -163,6 +164,8 @@ Bit8u imageDisk::Read_AbsoluteSector(Bit32u sectnum, void * data) {
 
 	bytenum = sectnum * sector_size;
 
+	if (compressed) return compressed->Read((Bit8u *)data, bytenum, sector_size) ? 0x00 : 0x05;
+
 	if (last_action==WRITE || bytenum!=current_fpos) fseek(diskimg,bytenum,SEEK_SET);
 	size_t ret=fread(data, 1, sector_size, diskimg);
 	current_fpos=bytenum+ret;
@@ -187,6 +190,8 @@ Bit8u imageDisk::Write_AbsoluteSector(Bit32u sectnum, void *data) {
 
 	//LOG_MSG("Writing sectors to %ld at bytenum %d", sectnum, bytenum);
 
+	if (compressed) return 0x03;	// write protected
+
 	if (last_action==READ || bytenum!=current_fpos) fseek(diskimg,bytenum,SEEK_SET);
 	size_t ret=fwrite(data, 1, sector_size, diskimg);
 	current_fpos=bytenum+ret;
@@ -205,6 +210,8 @@ imageDisk::imageDisk(FILE *imgFile, Bit8u *imgName, Bit32u imgSizeK, bool isHard
 	last_action = NONE;
 	diskimg = imgFile;
 	fseek(diskimg,0,SEEK_SET);
+	compressed = NULL;
+	if (CompressedImage::Detect(diskimg)) compressed = new CompressedImage(diskimg);
 	
 	memset(diskname,0,512);
 	if(strlen((const char *)imgName) > 511) {
@@ -241,6 +248,11 @@ imageDisk::imageDisk(FILE *imgFile, Bit8u *imgName, Bit32u imgSizeK, bool isHard
 	}
 }
 
+imageDisk::~imageDisk() {
+	delete compressed;
+	if(diskimg != NULL) { fclose(diskimg); }
+}
+
 void imageDisk::Set_Geometry(Bit32u setHeads, Bit32u setCyl, Bit32u setSect, Bit32u setSectSize) {
 	heads = setHeads;
 	cylinders = setCyl;
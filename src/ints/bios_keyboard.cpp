@@ -537,6 +537,7 @@ static Bitu INT16_Handler(void) {
 			} else {
 				/* no key available */
 				CALLBACK_SZF(true);
+				CALLBACK_IdlePoll();
 				break;
 			}
 //			CALLBACK_Idle();
@@ -547,6 +548,7 @@ static Bitu INT16_Handler(void) {
 		CALLBACK_SIF(true);
 		if (!check_key(temp)) {
 			CALLBACK_SZF(true);
+			CALLBACK_IdlePoll();
 		} else {
 			CALLBACK_SZF(false);
 			if (((temp&0xff)==0xf0) && (temp>>8)) {
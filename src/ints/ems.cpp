@@ -303,7 +303,7 @@ static Bit8u EMM_MapPage(Bitu phys_page,Bit16u handle,Bit16u log_page) {
 		emm_mappings[phys_page].page=NULL_PAGE;
 		for (Bitu i=0;i<4;i++)
 			PAGING_MapPage(EMM_PAGEFRAME4K+phys_page*4+i,EMM_PAGEFRAME4K+phys_page*4+i);
-		PAGING_ClearTLB();
+		PAGING_InvalidatePages(EMM_PAGEFRAME4K+phys_page*4,4);
 		return EMM_NO_ERROR;
 	}
 	/* Check for valid handle */
@@ -319,7 +319,7 @@ static Bit8u EMM_MapPage(Bitu phys_page,Bit16u handle,Bit16u log_page) {
 			PAGING_MapPage(EMM_PAGEFRAME4K+phys_page*4+i,memh);
 			memh=MEM_NextHandle(memh);
 		}
-		PAGING_ClearTLB();
+		PAGING_InvalidatePages(EMM_PAGEFRAME4K+phys_page*4,4);
 		return EMM_NO_ERROR;
 	} else  {
 		/* Illegal logical page it is */
@@ -361,7 +361,7 @@ static Bit8u EMM_MapSegment(Bitu segment,Bit16u handle,Bit16u log_page) {
 			}
 			for (Bitu i=0;i<4;i++)
 				PAGING_MapPage(segment*16/4096+i,segment*16/4096+i);
-			PAGING_ClearTLB();
+			PAGING_InvalidatePages(segment*16/4096,4);
 			return EMM_NO_ERROR;
 		}
 		/* Check for valid handle */
@@ -382,7 +382,7 @@ static Bit8u EMM_MapSegment(Bitu segment,Bit16u handle,Bit16u log_page) {
 				PAGING_MapPage(segment*16/4096+i,memh);
 				memh=MEM_NextHandle(memh);
 			}
-			PAGING_ClearTLB();
+			PAGING_InvalidatePages(segment*16/4096,4);
 			return EMM_NO_ERROR;
 		} else  {
 			/* Illegal logical page it is */
@@ -96,9 +96,9 @@
 #define BIOS_NCOLS Bit16u ncols=real_readw(BIOSMEM_SEG,BIOSMEM_NB_COLS);
 #define BIOS_NROWS Bit16u nrows=(Bit16u)real_readb(BIOSMEM_SEG,BIOSMEM_NB_ROWS)+1;
 
-extern Bit8u int10_font_08[256 * 8];
-extern Bit8u int10_font_14[256 * 14];
-extern Bit8u int10_font_16[256 * 16];
+extern const Bit8u int10_font_08[256 * 8];
+extern const Bit8u int10_font_14[256 * 14];
+extern const Bit8u int10_font_16[256 * 16];
 extern Bit8u int10_font_14_alternate[20 * 15 + 1];
 extern Bit8u int10_font_16_alternate[19 * 17 + 1];
 
@@ -94,7 +94,7 @@ const Bit8u vparams_tandy_td[] = {
 };
 
 
-static Bit8u video_parameter_table_vga[0x40*0x1d]={
+static const Bit8u video_parameter_table_vga[0x40*0x1d]={
 // video parameter table for mode 0 (cga emulation)
   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
@@ -326,7 +326,7 @@ static Bit8u video_parameter_table_vga[0x40*0x1d]={
   0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x05, 0x0f, 0xff  // graphics registers 0-8
 };
 
-static Bit8u video_parameter_table_ega[0x40*0x17]={
+static const Bit8u video_parameter_table_ega[0x40*0x17]={
 // video parameter table for mode 0 (cga emulation)
   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
@@ -11,6 +11,61 @@
 //pathnames
 #include <string>
 
+#if defined(HAVE_MMAP)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/* ROM file mapped read-only instead of read into the heap, which saves a
+ * temporary copy while the synth loads. The synth keeps its own copy of
+ * both ROMs (the PCM ROM converted to samples), so the resident ROM data
+ * is still private to each process. Falls back to a FileStream where
+ * mapping is unavailable. */
+class MappedROMFile : public MT32Emu::AbstractFile {
+public:
+	MappedROMFile() : data(NULL), size(0) {}
+	~MappedROMFile() { close(); }
+
+	bool open(const char *filename) {
+		close();
+#if defined(HAVE_MMAP)
+		int fd = ::open(filename, O_RDONLY);
+		if (fd >= 0) {
+			struct stat st;
+			if (fstat(fd, &st) == 0 && st.st_size > 0) {
+				void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+				if (map != MAP_FAILED) {
+					data = (const Bit8u *)map;
+					size = (size_t)st.st_size;
+				}
+			}
+			::close(fd);
+			if (data) return true;
+		}
+#endif
+		return stream.open(filename);
+	}
+
+	size_t getSize() { return data ? size : stream.getSize(); }
+	const Bit8u *getData() { return data ? data : stream.getData(); }
+
+	void close() {
+#if defined(HAVE_MMAP)
+		if (data) munmap((void *)data, size);
+#endif
+		data = NULL;
+		size = 0;
+		stream.close();
+	}
+
+private:
+	const Bit8u *data;
+	size_t size;
+	MT32Emu::FileStream stream;
+};
+
 class RingBuffer {
 private:
 	static const unsigned int bufferSize = 1024;
@@ -68,7 +123,7 @@ private:
 	} reportHandler;
 
 public:
-	MidiHandler_mt32() : open(false), chan(NULL), synth(NULL) {}
+	MidiHandler_mt32() : open(false), chan(NULL), synth(NULL), failed(false) {}
 
 	~MidiHandler_mt32() {
 		Close();
@@ -79,34 +134,81 @@ public:
 	}
 
 	bool Open(const char *conf) {
-		MT32Emu::FileStream controlROMFile;
-		MT32Emu::FileStream pcmROMFile;
+		MappedROMFile controlROMFile;
+		MappedROMFile pcmROMFile;
       
       char* syspath;
-      std::string path;
       bool worked = environ_cb(RETRO_ENVIRONMENT_GET_SYSTEM_DIRECTORY,(void *)&syspath);
       if(!worked)return false;
       
-      path = syspath;
-      if(path[path.length() - 1] != '/')path += '/';
-      path += "MT32_CONTROL.ROM";
-      if (!controlROMFile.open(path.c_str())) {
+      controlROMPath = syspath;
+      if(controlROMPath[controlROMPath.length() - 1] != '/')controlROMPath += '/';
+      pcmROMPath = controlROMPath;
+      controlROMPath += "MT32_CONTROL.ROM";
+      if (!controlROMFile.open(controlROMPath.c_str())) {
          LOG_MSG("MT32: Control ROM file not found");
          return false;
       }
-      path = syspath;
-      if(path[path.length() - 1] != '/')path += '/';
-      path += "MT32_PCM.ROM";
-      if (!pcmROMFile.open(path.c_str())) {
+      pcmROMPath += "MT32_PCM.ROM";
+      if (!pcmROMFile.open(pcmROMPath.c_str())) {
          LOG_MSG("MT32: PCM ROM file not found");
          return false;
       }
-      
+
+		//Loading the roms and opening the synth is slow, wait for the first message
+		chan = MIXER_AddChannel(mixerCallBack, MT32Emu::SAMPLE_RATE, "MT32");
+		failed = false;
+		open = true;
+		return true;
+	}
+
+	void Close(void) {
+		if (!open) return;
+		chan->Enable(false);
+		MIXER_DelChannel(chan);
+		chan = NULL;
+		if (synth) {
+			synth->close();
+			delete synth;
+			synth = NULL;
+		}
+		open = false;
+	}
+
+	void PlayMsg(Bit8u *msg) {
+		if (!synth && !StartSynth()) return;
+		if (!midiBuffer.put(*(Bit32u *)msg)) LOG_MSG("MT32: Playback buffer full!");
+	}
+
+	void PlaySysex(Bit8u *sysex, Bitu len) {
+		if (!synth && !StartSynth()) return;
+		synth->playSysex(sysex, len);
+	}
+
+private:
+	std::string controlROMPath, pcmROMPath;
+	bool failed;
+
+	bool StartSynth(void) {
+		if (failed) return false;
+		MappedROMFile controlROMFile;
+		MappedROMFile pcmROMFile;
+		failed = true;
+		if (!controlROMFile.open(controlROMPath.c_str()) || !pcmROMFile.open(pcmROMPath.c_str())) {
+			LOG_MSG("MT32: ROM files disappeared");
+			return false;
+		}
 		const MT32Emu::ROMImage *controlROMImage = MT32Emu::ROMImage::makeROMImage(&controlROMFile);
 		const MT32Emu::ROMImage *pcmROMImage = MT32Emu::ROMImage::makeROMImage(&pcmROMFile);
 		synth = new MT32Emu::Synth(&reportHandler);
-		if (!synth->open(*controlROMImage, *pcmROMImage)) {
+		bool opened = synth->open(*controlROMImage, *pcmROMImage);
+		// the synth keeps its own copies, the files are unmapped when leaving
+		MT32Emu::ROMImage::freeROMImage(controlROMImage);
+		MT32Emu::ROMImage::freeROMImage(pcmROMImage);
+		if (!opened) {
 			LOG_MSG("MT32: Error initialising emulation");
+			delete synth;
+			synth = NULL;
 			return false;
 		}
 
@@ -129,33 +231,11 @@ public:
 		reverseStereo = strcmp(section->Get_string("mt32.reverse.stereo"), "on") == 0;
 		noise = strcmp(section->Get_string("mt32.verbose"), "on") == 0;
 
-		chan = MIXER_AddChannel(mixerCallBack, MT32Emu::SAMPLE_RATE, "MT32");
 		chan->Enable(true);
-
-		open = true;
+		failed = false;
 		return true;
 	}
 
-	void Close(void) {
-		if (!open) return;
-		chan->Enable(false);
-		MIXER_DelChannel(chan);
-		chan = NULL;
-		synth->close();
-		delete synth;
-		synth = NULL;
-		open = false;
-	}
-
-	void PlayMsg(Bit8u *msg) {
-		if (!midiBuffer.put(*(Bit32u *)msg)) LOG_MSG("MT32: Playback buffer full!");
-	}
-
-	void PlaySysex(Bit8u *sysex, Bitu len) {
-		synth->playSysex(sysex, len);
-	}
-
-private:
 	static void mixerCallBack(Bitu len);
 
 	void render(Bitu len, Bit16s *buf) {
@@ -41,7 +41,7 @@ Bitu call_program;
 
 /* This registers a file on the virtual drive and creates the correct structure for it*/
 
-static Bit8u exe_block[]={
+static const Bit8u exe_block[]={
 	0xbc,0x00,0x04,					//MOV SP,0x400 decrease stack size
 	0xbb,0x40,0x00,					//MOV BX,0x040 for memory resize
 	0xb4,0x4a,						//MOV AH,0x4A	Resize memory block
@@ -29,6 +29,7 @@
 #include <limits>
 #include <cctype>
 #include <algorithm>
+#include <chrono>
 
 using namespace std;
 
@@ -231,6 +232,14 @@ bool Property::CheckValue(const Value& in, bool warn) {
     return false;
 }
 
+bool Property::CheckString(const string& input) {
+    Value val;
+    if (!val.SetValue(input, Get_type())) {
+        return false;
+    }
+    return CheckValue(val, false);
+}
+
 void Property::Set_help(const string& in) {
     string key = "CONFIG_" + propname;
     upcase(key);
@@ -304,6 +313,15 @@ bool Prop_int::SetValue(const string& input) {
     return SetVal(val, false, true);
 }
 
+bool Prop_int::CheckString(const string& input) {
+    Value val;
+    if (!val.SetValue(input, Value::V_INT)) {
+        return false;
+    }
+    // Without suggested values SetVal clamps to the range instead of failing
+    return suggested_values.empty() || CheckValue(val, false);
+}
+
 bool Prop_double::SetValue(const string& input) {
     Value val;
     if (!val.SetValue(input, Value::V_DOUBLE)) {
@@ -321,6 +339,14 @@ bool Prop_string::SetValue(const string& input) {
     return SetVal(val, false, true);
 }
 
+bool Prop_string::CheckString(const string& input) {
+    string temp = input;
+    if (!suggested_values.empty()) {
+        lowcase(temp);
+    }
+    return CheckValue(Value(temp, Value::V_STRING), false);
+}
+
 bool Prop_string::CheckValue(const Value& in, bool warn) {
     if (suggested_values.empty()) {
         return true;
@@ -358,6 +384,10 @@ bool Prop_path::SetValue(const string& input) {
     return retval;
 }
 
+bool Prop_path::CheckString(const string& input) {
+    return !input.empty() && CheckValue(Value(input, Value::V_STRING), false);
+}
+
 bool Prop_bool::SetValue(const string& input) {
     Value val;
     if (!val.SetValue(input, Value::V_BOOL)) {
@@ -394,36 +424,16 @@ void Prop_multival::make_default_value() {
     SetVal(val, false, true);
 }
 
-bool Prop_multival::SetValue(const string& input) {
-    Value val(input, Value::V_STRING);
-    bool retval = SetVal(val, false, true);
-    string local = input;
-    size_t i = 0;
-    while (Property* p = section->Get_prop(i++)) {
-        size_t loc = local.find_first_not_of(separator);
-        if (loc != string::npos) {
-            local.erase(0, loc);
-        }
-        loc = local.find_first_of(separator);
-        string in = loc != string::npos ? local.substr(0, loc) : local;
-        if (loc != string::npos) {
-            local.erase(0, loc + 1);
-        } else {
-            local.clear();
-        }
-        Value valtest(in, p->Get_type());
-        if (!p->CheckValue(valtest, true)) {
-            make_default_value();
-            return false;
-        }
-        p->SetValue(in);
+// Splits input over the sub properties and checks each part. With apply set
+// the parts are stored, otherwise nothing changes. The last part takes the
+// rest of the line for Prop_multival_remain.
+bool Prop_multival::ParseParts(const string& input, bool remain, bool apply) {
+    bool retval;
+    if (apply) {
+        retval = SetVal(Value(input, Value::V_STRING), false, true);
+    } else {
+        retval = CheckValue(Value(input, Value::V_STRING), false);
     }
-    return retval;
-}
-
-bool Prop_multival_remain::SetValue(const string& input) {
-    Value val(input, Value::V_STRING);
-    bool retval = SetVal(val, false, true);
     string local = input;
     size_t num_props = 0;
     while (section->Get_prop(num_props)) {
@@ -436,22 +446,42 @@ bool Prop_multival_remain::SetValue(const string& input) {
             local.erase(0, loc);
         }
         loc = local.find_first_of(separator);
-        string in = (loc != string::npos && i < num_props) ? local.substr(0, loc) : local;
+        string in = (loc != string::npos && (!remain || i < num_props)) ? local.substr(0, loc) : local;
         if (loc != string::npos) {
             local.erase(0, loc + 1);
         } else {
             local.clear();
         }
         Value valtest(in, p->Get_type());
-        if (!p->CheckValue(valtest, true)) {
-            make_default_value();
+        if (!p->CheckValue(valtest, apply)) {
+            if (apply) {
+                make_default_value();
+            }
             return false;
         }
-        p->SetValue(in);
+        if (apply) {
+            p->SetValue(in);
+        }
     }
     return retval;
 }
 
+bool Prop_multival::SetValue(const string& input) {
+    return ParseParts(input, false, true);
+}
+
+bool Prop_multival::CheckString(const string& input) {
+    return ParseParts(input, false, false);
+}
+
+bool Prop_multival_remain::SetValue(const string& input) {
+    return ParseParts(input, true, true);
+}
+
+bool Prop_multival_remain::CheckString(const string& input) {
+    return ParseParts(input, true, false);
+}
+
 const vector<Value>& Property::GetValues() const {
     return suggested_values;
 }
@@ -582,6 +612,15 @@ Property* Section_prop::Get_prop(int index) {
     return nullptr;
 }
 
+Property* Section_prop::Get_prop(const string& _propname) {
+    for (auto* prop : properties) {
+        if (strcasecmp(prop->propname.c_str(), _propname.c_str()) == 0) {
+            return prop;
+        }
+    }
+    return nullptr;
+}
+
 const char* Section_prop::Get_string(const string& _propname) const {
     for (const auto* prop : properties) {
         if (prop->propname == _propname) {
@@ -632,6 +671,49 @@ bool Section_prop::HandleInputline(const string& line) {
     return false;
 }
 
+bool Section_prop::ApplyValues(const vector<pair<string, string>>& values) {
+    vector<pair<Property*, const string*>> changed;
+    bool reinit = false;
+    bool result = true;
+    for (const auto& value : values) {
+        Property* prop = Get_prop(value.first);
+        if (!prop) {
+            result = false;
+            continue;
+        }
+        if (prop->GetValue().ToString() == value.second) {
+            continue;
+        }
+        if (!prop->Get_change_function()) {
+            reinit = true;
+        }
+        changed.emplace_back(prop, &value.second);
+    }
+    if (changed.empty()) {
+        return result;
+    }
+    if (reinit) {
+        ExecuteDestroy(false);
+    }
+    for (const auto& change : changed) {
+        result &= change.first->SetValue(*change.second);
+    }
+    if (reinit) {
+        ExecuteInit(false);
+        return result;
+    }
+    // Properties sharing a change function only trigger it once
+    vector<Property::ChangeFunction> called;
+    for (const auto& change : changed) {
+        Property::ChangeFunction func = change.first->Get_change_function();
+        if (std::find(called.begin(), called.end(), func) == called.end()) {
+            called.push_back(func);
+            func(this);
+        }
+    }
+    return result;
+}
+
 void Section_prop::PrintData(FILE* outfile) const {
     for (const auto* prop : properties) {
         fprintf(outfile, "%s=%s\n", prop->propname.c_str(), prop->GetValue().ToString().c_str());
@@ -741,10 +823,18 @@ Section_prop::~Section_prop() {
     }
 }
 
+// Startup profile, the time spent initialising each section and in total
 void Config::Init() {
+    using clock = std::chrono::steady_clock;
+    const auto start = clock::now();
     for (auto* sec : sectionlist) {
+        const auto sec_start = clock::now();
         sec->ExecuteInit();
+        fprintf(stderr, "[SETUP] Startup profile: %-10s %8.2f ms\n", sec->GetName(),
+                std::chrono::duration<double, std::milli>(clock::now() - sec_start).count());
     }
+    fprintf(stderr, "[SETUP] Startup profile: %-10s %8.2f ms\n", "total",
+            std::chrono::duration<double, std::milli>(clock::now() - start).count());
 }
 
 void Section::AddInitFunction(SectionFunction func, bool canchange) {
@@ -764,7 +854,10 @@ void Section::ExecuteInit(bool initall) {
             continue; // Skip null functions to avoid segfault
         }
         if (initall || wrapper.canchange) {
+            const auto start = std::chrono::steady_clock::now();
             wrapper.function(this);
+            fprintf(stderr, "[SETUP] Init function=%p took %.2f ms\n", (void*)wrapper.function,
+                    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
         }
     }
 }
@@ -25,6 +25,7 @@
 
 BatchFile::BatchFile(DOS_Shell * host,char const * const resolved_name,char const * const entered_name, char const * const cmd_line) {
 	location = 0;
+	loaded = false;
 	prev=host->bf;
 	echo=host->echo;
 	shell=host;
@@ -47,23 +48,79 @@ BatchFile::~BatchFile() {
 	shell->echo=echo;
 }
 
+bool BatchFile::LoadFile(void) {
+	if (!DOS_OpenFile(filename.c_str(),(DOS_NOT_INHERIT|OPEN_READ),&file_handle)) return false;
+	Bit32u size = 0;
+	Bit16u time = 0, date = 0;
+	DOS_SeekFile(file_handle,&size,DOS_SEEK_END);
+	DOS_GetFileDate(file_handle,&time,&date);
+	if (loaded && size == loaded_size && time == loaded_time && date == loaded_date) {
+		DOS_CloseFile(file_handle);
+		return true;
+	}
+	Bit32u done = 0;
+	DOS_SeekFile(file_handle,&done,DOS_SEEK_SET);
+	contents.resize(size);
+	while (done < size) {
+		Bit16u n = (Bit16u)((size - done) > 0x8000 ? 0x8000 : (size - done));
+		if (!DOS_ReadFile(file_handle,reinterpret_cast<Bit8u*>(&contents[done]),&n) || !n) break;
+		done += n;
+	}
+	contents.resize(done);
+	DOS_CloseFile(file_handle);
+
+	/* Index the labels with the location of the line after them */
+	labels.clear();
+	char cmd_buffer[CMD_MAXLINE];
+	for (Bit32u pos = 0; pos < done; ) {
+		char * cmd_write = cmd_buffer;
+		Bit8u c = 0;
+		while (pos < done) {
+			c = contents[pos++];
+			if (c > 31 && ((cmd_write - cmd_buffer) + 1) < (CMD_MAXLINE - 1))
+				*cmd_write++ = c;
+			if (c == '\n') break;
+		}
+		*cmd_write = 0;
+		char *nospace = trim(cmd_buffer);
+		if (nospace[0] != ':') continue;
+		nospace++; //Skip :
+		//Strip spaces and = from it.
+		while(*nospace && (isspace(*reinterpret_cast<unsigned char*>(nospace)) || (*nospace == '=')))
+			nospace++;
+
+		//label is until space/=/eol
+		char* const beginlabel = nospace;
+		while(*nospace && !isspace(*reinterpret_cast<unsigned char*>(nospace)) && (*nospace != '='))
+			nospace++;
+
+		*nospace = 0;
+		labels.push_back(std::make_pair(std::string(beginlabel),pos));
+	}
+	loaded = true;
+	loaded_size = size;
+	loaded_time = time;
+	loaded_date = date;
+	return true;
+}
+
 bool BatchFile::ReadLine(char * line) {
-	//Open the batchfile and seek to stored postion
-	if (!DOS_OpenFile(filename.c_str(),(DOS_NOT_INHERIT|OPEN_READ),&file_handle)) {
+	if (!LoadFile()) {
 		LOG(LOG_MISC,LOG_ERROR)("ReadLine Can't open BatchFile %s",filename.c_str());
 		delete this;
 		return false;
 	}
-	DOS_SeekFile(file_handle,&(this->location),DOS_SEEK_SET);
 
-	Bit8u c=0;Bit16u n=1;
 	char temp[CMD_MAXLINE];
-emptyline:
-	char * cmd_write=temp;
+	char * cmd_write;
 	do {
-		n=1;
-		DOS_ReadFile(file_handle,&c,&n);
-		if (n>0) {
+		if (location >= contents.size()) {
+			delete this;
+			return false;
+		}
+		cmd_write=temp;
+		while (location < contents.size()) {
+			Bit8u c = contents[location++];
 			/* Why are we filtering this ?
 			 * Exclusion list: tab for batch files 
 			 * escape for ansi
@@ -74,17 +131,10 @@ emptyline:
 				if (((cmd_write - temp) + 1) < (CMD_MAXLINE - 1))
 					*cmd_write++ = c;
 			}
+			if (c=='\n') break;
 		}
-	} while (c!='\n' && n);
-	*cmd_write=0;
-	if (!n && cmd_write==temp) {
-		//Close file and delete bat file
-		DOS_CloseFile(file_handle);
-		delete this;
-		return false;	
-	}
-	if (!strlen(temp)) goto emptyline;
-	if (temp[0]==':') goto emptyline;
+		*cmd_write=0;
+	} while (!temp[0] || temp[0]==':');
 
 	/* Now parse the line read from the bat file for % stuff */
 	cmd_write=line;
@@ -147,67 +197,23 @@ emptyline:
 		}
 	}
 	*cmd_write = 0;
-	//Store current location and close bat file
-	this->location = 0;
-	DOS_SeekFile(file_handle,&(this->location),DOS_SEEK_CUR);
-	DOS_CloseFile(file_handle);
 	return true;	
 }
 
 bool BatchFile::Goto(char * where) {
-	//Open bat file and search for the where string
-	if (!DOS_OpenFile(filename.c_str(),(DOS_NOT_INHERIT|OPEN_READ),&file_handle)) {
+	if (!LoadFile()) {
 		LOG(LOG_MISC,LOG_ERROR)("SHELL:Goto Can't open BatchFile %s",filename.c_str());
 		delete this;
 		return false;
 	}
-
-	char cmd_buffer[CMD_MAXLINE];
-	char * cmd_write;
-
-	/* Scan till we have a match or return false */
-	Bit8u c;Bit16u n;
-again:
-	cmd_write=cmd_buffer;
-	do {
-		n=1;
-		DOS_ReadFile(file_handle,&c,&n);
-		if (n>0) {
-			if (c>31) {
-				if (((cmd_write - cmd_buffer) + 1) < (CMD_MAXLINE - 1))
-					*cmd_write++ = c;
-			}
-		}
-	} while (c!='\n' && n);
-	*cmd_write++ = 0;
-	char *nospace = trim(cmd_buffer);
-	if (nospace[0] == ':') {
-		nospace++; //Skip :
-		//Strip spaces and = from it.
-		while(*nospace && (isspace(*reinterpret_cast<unsigned char*>(nospace)) || (*nospace == '=')))
-			nospace++;
-
-		//label is until space/=/eol
-		char* const beginlabel = nospace;
-		while(*nospace && !isspace(*reinterpret_cast<unsigned char*>(nospace)) && (*nospace != '=')) 
-			nospace++;
-
-		*nospace = 0;
-		if (strcasecmp(beginlabel,where)==0) {
-		//Found it! Store location and continue
-			this->location = 0;
-			DOS_SeekFile(file_handle,&(this->location),DOS_SEEK_CUR);
-			DOS_CloseFile(file_handle);
+	for (size_t i = 0; i < labels.size(); i++) {
+		if (strcasecmp(labels[i].first.c_str(),where)==0) {
+			//Found it! Store location and continue
+			this->location = labels[i].second;
 			return true;
 		}
-	   
-	}
-	if (!n) {
-		DOS_CloseFile(file_handle);
-		delete this;
-		return false;	
 	}
-	goto again;
+	delete this;
 	return false;
 }
 